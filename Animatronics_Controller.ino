@@ -5,28 +5,59 @@
 
 #include "audio.h"
 #include "config.h"
+#include "events.h"
+#include "idle.h"
 #include "interface.h"
+#include "lipsync.h"
+#include "memory.h"
+#include "playlist.h"
+#include "render.h"
+#include "sdio.h"
 #include "servo.h"
+#include "soak.h"
 #include "show.h"
+#include "sync.h"
+#include "telemetry.h"
+#include "timing.h"
+#include "trigger.h"
 #include <SD.h>
 
 #define INTERFACE_PIN 28
 #define TEST_PIN 29
+#define MENU_NONE 0
+#define MENU_MAIN 1
+#define MENU_SHOW 2
+#define MENU_CONFIG 3
 
 char versionNumber[] = "2.2.5";
+uint8_t menu = MENU_NONE;
 
 /**
 *   @brief  Setup the Animatronics Controller
 */
 void setup() {
+    // Audio needs no card, start it first so its output settles while the card comes up
+    setupAudio();
+    markBoot("Audio");
+
     if (!SD.begin(BUILTIN_SDCARD)) {
         while (!SD.begin(BUILTIN_SDCARD)) {
             // Wait for SD Card
         }
     }
 
+    markBoot("SD card");
+
     setupServos();
-    setupAudio();
+    markBoot("Config and servos");
+
+    setupOutputs();
+    setupLipsync();
+    setupSync();
+    setupTrigger();
+    scanShows();
+    loadPlaylist();
+    markBoot("Outputs, show scan and playlist");
 
     pinMode(INTERFACE_PIN, INPUT);
     bool interfaceButton = digitalRead(INTERFACE_PIN);
@@ -47,8 +78,11 @@ void setup() {
         Serial.println(" ----------");
         Serial.println("-----------------------------------\n");
         Serial.println(getFigureName());
+        printBoot();
+        printPlaylist();
 
-        mainMenu();
+        menu = MENU_MAIN;
+        printMenu();
     }
 
     if (testButton && !interfaceButton) {
@@ -61,94 +95,230 @@ void setup() {
 }
 
 /**
-*   @brief  Main program loop, load each show file and play it
+*   @brief  Main program loop, serve the menu or load each show file and play it
 */
 void loop() {
-    char fileName[8] = "";
+    // The audio of a show that ended before its WAV keeps playing from the ring, keep it filled
+    serviceIO();
 
-    for (uint8_t s = 0; s < 256; s++) {
-        sprintf(fileName, "%03d.ANI", s);
+    if (menu != MENU_NONE) {
+        serviceMenu();
+        return;
+    }
 
-        if (SD.exists(fileName)) {
-            if (loadShow(s)) {
-                playShow();
+    autoPlay();
+}
+
+/**
+*   @brief  Play the playlist or every show file once, follow the master or wait for the trigger
+*/
+void autoPlay() {
+    startIdle();
+    serviceIdle();
+
+    if (getSyncRole() == SYNC_FOLLOWER) {
+        followMaster();
+        return;
+    }
+
+    if (isTriggerMode()) {
+        triggerShow();
+        return;
+    }
+
+    if (hasPlaylist()) {
+        playPlaylist();
+        return;
+    }
+
+    bool played = false;
+
+    for (uint16_t s = 0; s < 256; s++) {
+        if (showExists(s) && loadShow(s)) {
+            markBoot("Show load");
+            playShow();
+            startIdle();
+            played = true;
+
+            if (isShowStopped()) {
+                return;
             }
-        } else {
-            delay(10);
         }
     }
+
+    if (!played) {
+        delay(10);
+    }
 }
 
 /**
-*   @brief  Main menu
+*   @brief  Wait for a timecode from the master and play the same show from the same time
+*/
+void followMaster() {
+    if (serviceSync() && loadShow(getSyncShow())) {
+        playShowAt(getSyncMS());
+    }
+}
+
+/**
+*   @brief  Handle a menu option if one has arrived, returns straight away if not
+*/
+void serviceMenu() {
+    if (Serial.available() <= 0) {
+        return;
+    }
+
+    char option = getChar();
+
+    switch (menu) {
+        case MENU_MAIN:
+            mainMenu(option);
+            break;
+        case MENU_SHOW:
+            loadedShowMenu(option);
+            break;
+        case MENU_CONFIG:
+            configMenu(option);
+            break;
+    }
+
+    printMenu();
+}
+
+/**
+*   @brief  Print the options of the current menu
 */
-void mainMenu() {
+void printMenu() {
     Serial.println("\n-------------------------------");
-    Serial.println("n - New Show File");
-    Serial.println("l - Load Show File");
-    Serial.println("a - Auto Play");
-    Serial.println("t - Test");
-    Serial.println("c - Configure");
+
+    switch (menu) {
+        case MENU_MAIN:
+            Serial.println("n - New Show File");
+            Serial.println("l - Load Show File");
+            Serial.println("a - Auto Play");
+            Serial.println("t - Test");
+            Serial.println("c - Configure");
+            break;
+        case MENU_SHOW:
+            Serial.print("Loaded Show #");
+            Serial.print(getShowNumber());
+            Serial.print(" | ");
+            Serial.println(getShowName());
+            Serial.println("-------------------------------");
+            Serial.println("p - Play Show File");
+            Serial.println("g - Play Show From Time");
+            Serial.println("j - Jog Show File");
+            Serial.println("l - Loop Show File");
+            Serial.println("r - Record Show File");
+            Serial.println("n - Change Show File Name");
+            Serial.println("v - Add Show Event");
+            Serial.println("w - Render Show File");
+            Serial.println("m - Toggle Telemetry");
+            Serial.println("i - Timing Report");
+            Serial.println("s - Save Show File");
+            Serial.println("d - Delete Show File");
+            Serial.println("e - Exit");
+            break;
+        case MENU_CONFIG:
+            Serial.println("i - Config Input");
+            Serial.println("c - Config Servo");
+            Serial.println("x - Invert Servo");
+            Serial.println("f - Servo Filter");
+            Serial.println("v - Servo Motion Limits");
+            Serial.println("l - Servo Latency");
+            Serial.println("d - Enable/Disable Servo");
+            Serial.println("b - Config Servo Boards");
+            Serial.println("o - Config Output");
+            Serial.println("y - Config Sync");
+            Serial.println("m - Config Lip Sync");
+            Serial.println("a - Config Idle");
+            Serial.println("g - Config Trigger");
+            Serial.println("n - Change Name");
+            Serial.println("s - Save Config File");
+            Serial.println("r - Reload Config File");
+            Serial.println("t - Test");
+            Serial.println("e - Exit");
+            break;
+    }
+
     Serial.println("-------------------------------\n");
+
+    if (menu == MENU_SHOW) {
+        Serial.println("While playing: s - Stop | p - Pause | ? - Status | + / - Volume | m - Telemetry\n");
+    }
+
     Serial.print("Select an option: ");
+}
 
-    switch (getChar()) {
+/**
+*   @brief  Main menu
+*
+*   @param  option  Menu option
+*/
+void mainMenu(char option) {
+    switch (option) {
         case 'n':
             newShow();
-            loadedShowMenu();
+            menu = MENU_SHOW;
             break;
         case 'l':
             Serial.print("\nEnter show number 0-255: ");
             if (loadShow(getInt())) {
-                loadedShowMenu();
+                menu = MENU_SHOW;
             }
             break;
         case 'a':
-            loop();
+            // Until a show is stopped or a key is pressed between shows
+            do {
+                autoPlay();
+            } while (!isShowStopped() && Serial.available() == 0);
+
+            stopIdle();
             break;
         case 't':
             testShow();
             break;
         case 'c':
-            configMenu();
+            menu = MENU_CONFIG;
             break;
         default:
             Serial.println("Invalid value...\n");
             break;
     }
-
-    mainMenu();
 }
 
 /**
 *   @brief  Loaded show menu
+*
+*   @param  option  Menu option
 */
-void loadedShowMenu() {
-    Serial.print("\nLoaded Show #");
-    Serial.print(getShowNumber());
-    Serial.print(" | ");
-    Serial.println(getShowName());
-    Serial.println("-------------------------------");
-    Serial.println("p - Play Show File");
-    Serial.println("l - Loop Show File");
-    Serial.println("r - Record Show File");
-	Serial.println("n - Change Show File Name");
-    Serial.println("s - Save Show File");
-    Serial.println("d - Delete Show File");
-    Serial.println("e - Exit");
-    Serial.println("-------------------------------\n");
-    Serial.print("Select an option: ");
+void loadedShowMenu(char option) {
+    uint32_t eventMS;
+    uint8_t eventOutput;
 
-    switch (getChar()) {
+    switch (option) {
         case 'p':
             playShow();
             break;
+        case 'g':
+            Serial.print("\nEnter show time in milliseconds: ");
+            playShowAt(getInt());
+            break;
+        case 'j':
+            jogShow();
+            break;
         case 'l':
-            while (true) {
+            do {
                 playShow();
-            }
+            } while (!isShowStopped());
             break;
         case 'r':
+            // Servos enabled since the show was loaded need their tracks in memory before recording
+            if (!growShow()) {
+                Serial.println("Not enough memory to record every servo");
+                break;
+            }
+
             Serial.println("\nRecording in...");
             delay(1000);
             Serial.println("3...");
@@ -164,44 +334,60 @@ void loadedShowMenu() {
 			Serial.print("Enter show name: ");
 			setShowName(getString());
         	break;
+        case 'v':
+            printEvents();
+            Serial.print("Enter event time in milliseconds: ");
+            eventMS = getInt();
+            Serial.print("Enter output number 0-7: ");
+            eventOutput = getInt();
+            Serial.print("Enter output value 0-255: ");
+            if (!addEvent(eventMS, eventOutput, getInt())) {
+                Serial.println("Event not added...\n");
+            }
+            break;
+        case 'w':
+            renderShow();
+            break;
+        case 'm':
+            setTelemetry(!isTelemetryEnabled());
+            Serial.println(isTelemetryEnabled() ? "Telemetry on" : "Telemetry off");
+            break;
+        case 'i':
+            printTiming();
+            printBoot();
+            printPlaylist();
+            printIO();
+            printSync();
+            printRender();
+            printTelemetry();
+            printMemory();
+            printSoak();
+            break;
         case 's':
             saveShow();
             break;
         case 'd':
             deleteShow();
-            mainMenu();
+            menu = MENU_MAIN;
             break;
         case 'e':
-            mainMenu();
+            menu = MENU_MAIN;
             break;
         default:
             Serial.println("Invalid value...\n");
             break;
     }
-
-    loadedShowMenu();
 }
 
 /**
 *   @brief  Config menu
+*
+*   @param  option  Menu option
 */
-void configMenu() {
+void configMenu(char option) {
     uint8_t numb;
-	
-	Serial.println("\n-------------------------------");
-    Serial.println("i - Config Input");
-    Serial.println("c - Config Servo");
-    Serial.println("x - Invert Servo");
-	Serial.println("f - Servo Filter");
-    Serial.println("d - Enable/Disable Servo");
-	Serial.println("n - Change Name");
-    Serial.println("s - Save Config File");
-    Serial.println("t - Test");
-    Serial.println("e - Exit");
-    Serial.println("-------------------------------\n");
-    Serial.print("Select an option: ");
 
-    switch (getChar()) {
+    switch (option) {
         case 'i':
             printInputs();
 			Serial.print("Enter input number 0-15: ");
@@ -209,27 +395,59 @@ void configMenu() {
             break;
         case 'c':
             printServos();
-			Serial.print("Enter servo number 0-15: ");
+			Serial.print("Enter servo number 0-63: ");
             configServo(getInt());
             break;
         case 'x':
         	printServos();
-			Serial.print("Enter servo number 0-15: ");
+			Serial.print("Enter servo number 0-63: ");
             invertServo(getInt());
             break;
 	    case 'f':
         	printServos();
-			Serial.print("Enter servo number 0-15: ");
+			Serial.print("Enter servo number 0-63: ");
 	        filterServo(getInt());
 	        break;
+        case 'v':
+            printServos();
+            Serial.print("Enter servo number 0-63: ");
+            configProfile(getInt());
+            break;
+        case 'l':
+            printServos();
+            Serial.print("Enter servo number 0-63: ");
+            configLatency(getInt());
+            break;
         case 'd':
         	printServos();
-			Serial.print("Enter servo number 0-15: ");
+			Serial.print("Enter servo number 0-63: ");
             toggleServo(getInt());
             break;
+        case 'b':
+            configBoards();
+            break;
+        case 'y':
+            configSync();
+            break;
+        case 'm':
+            configLipsync();
+            break;
+        case 'a':
+            configIdle();
+            break;
+        case 'g':
+            configTrigger();
+            break;
+        case 'o':
+            Serial.print("Enter output number 0-7: ");
+            configOutput(getInt());
+            break;
         case 's':
             saveConfig();
             break;
+        case 'r':
+            reloadConfig();
+            break;
 	    case 'n':
 	    	Serial.println("\n-------------------------------");
 	    	Serial.println("i - Input");
@@ -246,7 +464,7 @@ void configMenu() {
 		            break;
 		        case 's':
 	        		printServos();
-					Serial.print("Enter servo number 0-15: ");
+					Serial.print("Enter servo number 0-63: ");
 					numb = getInt();
 					Serial.print("Enter servo name: ");
 					setServoName(numb, getString());
@@ -260,12 +478,10 @@ void configMenu() {
             testShow();
             break;
         case 'e':
-            mainMenu();
+            menu = MENU_MAIN;
             break;
         default:
             Serial.println("Invalid value...\n");
             break;
     }
-
-    configMenu();
 }
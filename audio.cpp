@@ -4,53 +4,103 @@
 */
 
 #include "audio.h"
+#include "lipsync.h"
 #include "show.h"
+#include "wavplayer.h"
 #include <Audio.h>
 #include <SD.h>
 
-AudioPlaySdWav       sdWav;
+AudioPlayShowWav     showWav;
+AudioAnalyzeLipsync  lipsync(showWav);
 AudioAmplifier       ampLeft;
 AudioAmplifier       ampRight;
 AudioOutputPT8211    pt8211;
-AudioConnection      patchCord1(sdWav, 0, ampLeft, 0);
-AudioConnection      patchCord2(sdWav, 1, ampRight, 0);
+AudioConnection      patchCord1(showWav, 0, ampLeft, 0);
+AudioConnection      patchCord2(showWav, 1, ampRight, 0);
 AudioConnection      patchCord3(ampLeft, 0, pt8211, 0);
 AudioConnection      patchCord4(ampRight, 0, pt8211, 1);
+AudioConnection      patchCord5(showWav, 0, lipsync, 0);
 
-float gainLvl = 0.5;
+uint8_t volume = 50;  // Percent
 
 void setupAudio() {
-    AudioMemory(8);
+    AudioMemory(AUDIO_BLOCKS);
 
-    ampLeft.gain(gainLvl);
-    ampRight.gain(gainLvl);
+    setVolume(volume);
 }
 
-uint32_t getAudioMS() {
-    ampLeft.gain(0);
-    ampRight.gain(0);
+void setVolume(uint8_t percent) {
+    volume = min(percent, 100);
+    ampLeft.gain(volume / 100.0);
+    ampRight.gain(volume / 100.0);
+}
+
+uint8_t getVolume() {
+    return volume;
+}
 
+uint32_t getAudioMS() {
     char audioFile[8] = "";
     sprintf(audioFile, "%03d.WAV", getShowNumber());
 
-    sdWav.play(audioFile);
-    delay(1000);
-    uint32_t audioMS = sdWav.lengthMillis();
-    sdWav.stop();
+    // The length comes from the WAV header, nothing is played
+    uint32_t audioMS = 0;
+
+    if (showWav.play(audioFile, 0)) {
+        audioMS = showWav.lengthMillis();
+    }
 
-    ampLeft.gain(gainLvl);
-    ampRight.gain(gainLvl);
+    showWav.stop();
 
     return audioMS;
 }
 
-void playAudio() {
+void playAudio(uint32_t ms) {
+    cueAudio(ms);
+    startAudio();
+}
+
+void cueAudio(uint32_t ms) {
     char audioFile[8] = "";
     sprintf(audioFile, "%03d.WAV", getShowNumber());
 
-    sdWav.play(audioFile);
+    if (showWav.cue(audioFile, ms)) {
+        showWav.refill(WAV_RING_SAMPLES / 256);
+    }
+}
+
+void startAudio() {
+    showWav.start();
+}
+
+uint32_t getAudioStartUS() {
+    return showWav.startMicros();
+}
+
+void pauseAudio() {
+    showWav.pause();
 }
 
 void stopAudio() {
-    sdWav.stop();
+    showWav.stop();
+}
+
+bool isAudioPlaying() {
+    return showWav.isPlaying();
+}
+
+uint16_t refillAudio(uint16_t maxSectors) {
+    return showWav.refill(maxSectors);
+}
+
+uint32_t getAudioBufferedMS() {
+    return showWav.bufferedMillis();
+}
+
+uint8_t getAudioEnvelope() {
+    return lipsync.read();
+}
+
+uint32_t getAudioUnderruns() {
+    return showWav.underruns();
 }
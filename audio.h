@@ -8,6 +8,8 @@
 
     #include <Arduino.h>
 
+    #define AUDIO_BLOCKS 8
+
     /**
     *   @brief  Setup audio output (Note: This is required)
     */
@@ -22,12 +24,88 @@
 
     /**
     *   @brief  Play WAV file associated with the loaded show
+    *
+    *   @param  ms  Position to start playing from in milliseconds, 0 ... 4294967295
+    */
+    void playAudio(uint32_t ms);
+
+    /**
+    *   @brief  Open the WAV file associated with the loaded show and fill its buffer without playing it
+    *
+    *   @param  ms  Position to start playing from in milliseconds, 0 ... 4294967295
+    */
+    void cueAudio(uint32_t ms);
+
+    /**
+    *   @brief  Start playing the cued WAV file on the next audio update, safe to call from an interrupt
+    */
+    void startAudio(void);
+
+    /**
+    *   @brief  Get the time the first audio block of the WAV file was sent
+    *
+    *   @return Returns micros() of the first block, 0 if none has been sent yet
     */
-    void playAudio(void);
+    uint32_t getAudioStartUS(void);
 
     /**
     *   @brief  Stop playing WAV file
     */
     void stopAudio(void);
 
+    /**
+    *   @brief  Pause the WAV file, startAudio() resumes it
+    */
+    void pauseAudio(void);
+
+    /**
+    *   @brief  Set the audio volume
+    *
+    *   @param  percent Volume, 0 ... 100
+    */
+    void setVolume(uint8_t percent);
+
+    /**
+    *   @brief  Get the audio volume
+    *
+    *   @return Returns the volume, 0 ... 100
+    */
+    uint8_t getVolume(void);
+
+    /**
+    *   @brief  Check if the WAV file is playing
+    *
+    *   @return ```true``` if playing and ```false``` if stopped or finished
+    */
+    bool isAudioPlaying(void);
+
+    /**
+    *   @brief  Read the WAV file into the audio ring buffer, only sdio.cpp should call this
+    *
+    *   @param  maxSectors  Max number of 512 byte sectors to read
+    *   @return Returns the number of sectors read
+    */
+    uint16_t refillAudio(uint16_t maxSectors);
+
+    /**
+    *   @brief  Get the amount of audio buffered ahead of the output in milliseconds
+    *
+    *   @return Returns the buffered audio in milliseconds, 0 ... 93
+    */
+    uint32_t getAudioBufferedMS(void);
+
+    /**
+    *   @brief  Get the lip sync envelope of the audio just ahead of the output
+    *
+    *   @return Returns the envelope scaled for a servo track, 0 ... 255
+    */
+    uint8_t getAudioEnvelope(void);
+
+    /**
+    *   @brief  Get the number of audio updates that found no audio buffered
+    *
+    *   @return Returns the number of audio underruns since the WAV file started
+    */
+    uint32_t getAudioUnderruns(void);
+
 #endif  // AUDIO_H_
@@ -0,0 +1,48 @@
+/**
+*   @file   channels.h
+*   @brief  Frame loop over the servo tracks of a uniform show
+*
+*   Kept free of Arduino so tools/channelbench.cpp can time the specialized loop against
+*   the generic one on a PC with the same code the controller runs.
+*/
+
+#ifndef CHANNELS_H_
+    #define CHANNELS_H_
+
+    #ifdef ARDUINO
+        #include <Arduino.h>
+    #else
+        #include <stdint.h>
+    #endif
+
+    /**
+    *   @brief  Play one frame of CHANNELS servo tracks of SAMPLE sized values
+    *
+    *   With a CHANNELS known at compile time the loop is unrolled and the track offsets fold
+    *   to multiples of maxFrames. CHANNELS 0 is the generic loop over count servos.
+    *   SERVOS supplies enabled(s), lead(s) and play(s, value) and is inlined into the loop.
+    *
+    *   @param  tracks      First sample of the first track, tracks follow each other maxFrames apart
+    *   @param  frame       Frame number, 0x0000 ... 0xFFE0
+    *   @param  maxFrames   Frames per track
+    *   @param  count       Number of servos, only used when CHANNELS is 0
+    *   @param  servos      Servo state to read and output to play
+    */
+    template <uint8_t CHANNELS, typename SAMPLE, typename SERVOS>
+    inline void playChannels(const SAMPLE* tracks, uint32_t frame, uint32_t maxFrames, uint8_t count, SERVOS &servos) {
+        const uint8_t channels = (CHANNELS != 0) ? CHANNELS : count;
+        const SAMPLE* track = tracks;
+
+        for (uint8_t s = 0; s < channels; s++, track += maxFrames) {
+            if (!servos.enabled(s)) {
+                continue;
+            }
+
+            uint32_t at = frame + servos.lead(s);
+
+            // Wider samples keep their top 8 bits, the servo math is 8 bit
+            servos.play(s, track[(at < maxFrames) ? at : maxFrames - 1] >> ((sizeof(SAMPLE) - 1) * 8));
+        }
+    }
+
+#endif  // CHANNELS_H_
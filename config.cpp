@@ -4,26 +4,121 @@
 */
 
 #include "config.h"
+#include "crc.h"
 #include "interface.h"
+#include "layout.h"
+#include "render.h"
 #include "servo.h"
 #include "show.h"
+#include "storage.h"
+#include "sync.h"
 #include <SD.h>
 
-#define CONF_BYTE_SIZE 0x30F
+#define CONF_VERSION 2  // 0/1 16 servos on one board | 2 up to 64 servos on 4 boards
 char configFile[8] = "FIG.CFG";
 File CONFIG_FILE;
-uint8_t conf[CONF_BYTE_SIZE + 1] = {};
+config_t conf = {};
+char inputNames[16][9];
+char servoNames[MAX_SERVOS][9];
+uint32_t servoConfigKey = 0;
+
+static_assert(sizeof(config_t) == CONF_SIZE, "config_t does not match the config file size");
+static_assert(offsetof(config_t, version) == CONF_VERSION_BYTE, "config_t version is misplaced");
+static_assert(offsetof(config_t, boardAddress) == CONF_BOARD_ADDRESS, "config_t boardAddress is misplaced");
+static_assert(offsetof(config_t, lipsync) == CONF_LIPSYNC, "config_t lipsync is misplaced");
+static_assert(offsetof(config_t, idle) == CONF_IDLE, "config_t idle is misplaced");
+static_assert(offsetof(config_t, outputs) == CONF_OUTPUTS, "config_t outputs is misplaced");
+static_assert(offsetof(config_t, trigger) == CONF_TRIGGER, "config_t trigger is misplaced");
+static_assert(offsetof(config_t, boardBus) == CONF_BOARD_BUS, "config_t boardBus is misplaced");
+static_assert(offsetof(config_t, curves) == CONF_CURVES, "config_t curves is misplaced");
+static_assert(offsetof(config_t, inputs) == CONF_INPUTS, "config_t inputs is misplaced");
+static_assert(offsetof(config_t, servosLow) == CONF_SERVOS_LOW, "config_t servosLow is misplaced");
+static_assert(offsetof(config_t, filtersLow) == CONF_FILTERS_LOW, "config_t filtersLow is misplaced");
+static_assert(offsetof(config_t, latency) == CONF_LATENCY, "config_t latency is misplaced");
+static_assert(offsetof(config_t, servosHigh) == CONF_SERVOS_HIGH, "config_t servosHigh is misplaced");
+static_assert(offsetof(config_t, filtersHigh) == CONF_FILTERS_HIGH, "config_t filtersHigh is misplaced");
+static_assert(offsetof(config_t, profiles) == CONF_PROFILES, "config_t profiles is misplaced");
+static_assert(offsetof(conf_servo_t, input) == FIELD_INPUT && offsetof(conf_servo_t, name) == FIELD_NAME, "conf_servo_t is misplaced");
+static_assert(offsetof(conf_input_t, max) == FIELD_MAX && offsetof(conf_input_t, name) == FIELD_NAME, "conf_input_t is misplaced");
+
+conf_servo_t &servoRecord(uint8_t number) {
+    return (number < 16) ? conf.servosLow[number] : conf.servosHigh[number - 16];
+}
+
+uint8_t &servoFilter(uint8_t number) {
+    return (number < 16) ? conf.filtersLow[number] : conf.filtersHigh[number - 16];
+}
+
+void copyName(char* name, const char* record) {
+    memcpy(name, record, 8);
+    name[8] = 0x00;
+}
+
+/**
+*   @brief  Store a name in a record, cut to 8 characters and padded with 0
+*
+*   @param  record  Name field of the record, char[8] with no terminator
+*   @param  name    Name to store
+*/
+void storeName(char* record, const char* name) {
+    size_t length = strnlen(name, 8);
+
+    memcpy(record, name, length);
+    memset(record + length, 0, 8 - length);
+}
+
+void loadNames() {
+    for (uint8_t i = 0; i < 16; i++) {
+        copyName(inputNames[i], conf.inputs[i].name);
+    }
+
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
+        copyName(servoNames[s], servoRecord(s).name);
+    }
+}
+
+uint32_t getServoConfigKey() {
+    const uint8_t* bytes = (const uint8_t*)&conf;
+    uint32_t key = crc32(0, bytes + CONF_SERVOS_LOW, CONF_LATENCY + (MAX_SERVOS * CONF_LATENCY_SIZE) - CONF_SERVOS_LOW);  // Servos 0-15, filters and latencies
+    return crc32(key, bytes + CONF_SERVOS_HIGH, confFilter(64) - CONF_SERVOS_HIGH);  // Servos 16-63 and filters
+}
+
+/**
+*   @brief  Clear every field version 1 did not have, a longer older file holds other data there
+*
+*   Version 1 had the name, the inputs and servos 0-15 with their filters, every later field
+*   loads at its default of 0 instead of as latencies, servos 16-63 or settings from that data.
+*/
+void keepVersion1() {
+    config_t v1 = {};
+
+    v1.version = conf.version;
+    memcpy(v1.name, conf.name, sizeof(v1.name));
+    memcpy(v1.inputs, conf.inputs, sizeof(v1.inputs));
+    memcpy(v1.servosLow, conf.servosLow, sizeof(v1.servosLow));
+    memcpy(v1.filtersLow, conf.filtersLow, sizeof(v1.filtersLow));
+
+    conf = v1;
+}
 
 void loadConfig() {
+    recoverSave(configFile);
+
     if (SD.exists(configFile)) {
         CONFIG_FILE = SD.open(configFile);
 
         if (CONFIG_FILE) {
-            while (CONFIG_FILE.available()) {
-                CONFIG_FILE.read(conf, sizeof(conf));
+            // A short file from older firmware leaves the fields it does not have at 0
+            memset(&conf, 0, sizeof(conf));
+            CONFIG_FILE.read((uint8_t*)&conf, sizeof(conf));
+            CONFIG_FILE.close();
+
+            if (conf.version < 2) {
+                keepVersion1();
             }
 
-            CONFIG_FILE.close();
+            loadNames();
+            servoConfigKey = getServoConfigKey();
         } else {
             Serial.print("Error opening: ");
             Serial.println(configFile);
@@ -43,7 +138,6 @@ void saveConfig() {
 
         switch (getChar()) {
             case 'y':
-                SD.remove(configFile);
                 break;
             default:
                 return;
@@ -51,91 +145,68 @@ void saveConfig() {
         }
     }
 
-    CONFIG_FILE = SD.open(configFile, FILE_WRITE);
+    conf.version = CONF_VERSION;
 
-    if (CONFIG_FILE) {
-        CONFIG_FILE.write(conf, sizeof(conf));
-        CONFIG_FILE.close();
-		setupServos();
-    } else {
-        Serial.print("Error opening: ");
-        Serial.println(configFile);
+    if (beginSave(configFile)) {
+        if (writeSave((const uint8_t*)&conf, sizeof(conf)) && commitSave()) {
+            if (getServoConfigKey() != servoConfigKey) {
+                // Every render was made with the old servo settings
+                clearRenders();
+                servoConfigKey = getServoConfigKey();
+            }
+
+            reloadServos();
+        } else {
+            abortSave();
+        }
     }
 }
 
+void reloadConfig() {
+    loadConfig();
+    reloadServos();
+    setupOutputs();
+    setupLipsync();
+    setupSync();
+    setupTrigger();
+}
+
 char* getFigureName() {
     static char name[17];
-    memset(name, 0, sizeof name);
 
-    for (uint8_t c = 0; c <= 16; c++) {
-        if (conf[c] != 0x00) {
-            name[c] = conf[c];
-        }
-    }
+    memcpy(name, conf.name, 16);
+    name[16] = 0x00;
 
     return name;
 }
 
 char* getInputName(uint8_t number) {
-    uint16_t inputBase = 0x108 + (number * 0x10);
-    static char name[9];
-    memset(name, 0, sizeof name);
-
-    for (uint8_t c = 0; c <= 8; c++) {
-        if (conf[inputBase + c] != 0x00) {
-            name[c] = conf[inputBase + c];
-        }
-    }
-
-    return name;
+    return inputNames[number];
 }
 
 void setInputName(uint8_t number, char* name) {
-    uint16_t inputBase = 0x108 + (number * 0x10);
-
-    for (uint8_t c = 0; c < 8; c++) {
-        if (name[c] != 0x00) {
-            conf[inputBase + c] = name[c];
-        } else {
-        	conf[inputBase + c] = 0x00;
-        }
-    }
+    storeName(conf.inputs[number].name, name);
+    copyName(inputNames[number], conf.inputs[number].name);
 }
 
 char* getServoName(uint8_t number) {
-    uint16_t servoBase = 0x208 + (number * 0x10);
-    static char name[9];
-    memset(name, 0, sizeof name);
-
-    for (uint8_t c = 0; c <= 8; c++) {
-        if (conf[servoBase + c] != 0x00) {
-            name[c] = conf[servoBase + c];
-        }
-    }
-
-    return name;
+    return servoNames[number];
 }
 
 void setServoName(uint8_t number, char* name) {
-    uint16_t servoBase = 0x208 + (number * 0x10);
-
-    for (uint8_t c = 0; c < 8; c++) {
-        if (name[c] != 0x00) {
-            conf[servoBase + c] = name[c];
-		} else {
-			conf[servoBase + c] = 0x00;
-		}
-    }
+    storeName(servoRecord(number).name, name);
+    copyName(servoNames[number], servoRecord(number).name);
 }
 
 input_t getInputData(uint8_t number) {
     input_t i;
-    uint16_t inputBase = 0x100 + (number * 0x10);
+    const conf_input_t &record = conf.inputs[number];
 
-    i.enabled = conf[inputBase];
-    i.pin = conf[inputBase + 1];
-    i.min = (conf[inputBase + 3] << 8) + conf[inputBase + 2];
-    i.max = (conf[inputBase + 5] << 8) + conf[inputBase + 4];
+    i.enabled = record.enabled;
+    i.number = number;
+    i.pin = record.pin;
+    i.min = record.min;
+    i.max = record.max;
     i.value = 0;
 
     return i;
@@ -143,35 +214,88 @@ input_t getInputData(uint8_t number) {
 
 servo_t getServoData(uint8_t number) {
     servo_t s;
-    uint16_t servoBase = 0x200 + (number * 0x10);
-	uint16_t servoFilterBase = 0x300 + number;
-
-    s.enabled = conf[servoBase];
-    s.pin = conf[servoBase + 1];
-    s.min = (conf[servoBase + 3] << 8) + conf[servoBase + 2];
-    s.max = (conf[servoBase + 5] << 8) + conf[servoBase + 4];
-    s.input = getInputData(conf[servoBase + 6]);
-    s.invert = conf[servoBase + 7];
+    const conf_servo_t &record = servoRecord(number);
+
+    s.enabled = record.enabled;
+    s.pin = record.pin;
+    s.min = record.min;
+    s.max = record.max;
+    s.input = getInputData(record.input);
+    s.invert = record.invert;
     s.value = 0;
-	s.filter = conf[servoFilterBase];
+	s.filter = servoFilter(number);
+    s.lead = conf.latency[number].play;
 
     return s;
 }
 
-uint16_t getServoCenter(uint8_t number) {
-    uint16_t servoBase = 0x200 + (number * 0x10);
+curve_t getCurveData(uint8_t number) {
+    return conf.curves[number];
+}
+
+profile_t getProfileData(uint8_t number) {
+    return conf.profiles[number];
+}
+
+latency_t getLatencyData(uint8_t number) {
+    return conf.latency[number];
+}
+
+uint8_t getBoardCount() {
+    if (conf.version < 2 || conf.boardCount == 0) {
+        return 1;
+    }
+
+    return min(conf.boardCount, MAX_BOARDS);
+}
+
+uint8_t getBoardAddress(uint8_t board) {
+    if (conf.version < 2 || conf.boardAddress[board] == 0) {
+        return 0x40 + board;
+    }
+
+    return conf.boardAddress[board];
+}
+
+uint8_t getBoardBus(uint8_t board) {
+    if (conf.version < 2 || conf.boardBus[board] >= I2C_BUSES) {
+        return 0;
+    }
+
+    return conf.boardBus[board];
+}
+
+uint8_t getSyncConfig() {
+    return conf.syncRole;
+}
+
+lipsync_t getLipsyncData() {
+    return conf.lipsync;
+}
+
+idle_t getIdleData() {
+    return conf.idle;
+}
+
+trigger_t getTriggerData() {
+    return conf.trigger;
+}
 
-    uint16_t min = (conf[servoBase + 3] << 8) + conf[servoBase + 2];
-    uint16_t max = (conf[servoBase + 5] << 8) + conf[servoBase + 4];
+output_t getOutputData(uint8_t number) {
+    return conf.outputs[number];
+}
+
+uint16_t getServoCenter(uint8_t number) {
+    const conf_servo_t &record = servoRecord(number);
 
-    uint16_t center = ((max - min) / 2) + min;
+    uint16_t center = ((record.max - record.min) / 2) + record.min;
 
     return center;
 }
 
 uint16_t* minmaxInput(uint8_t input) {
-    uint16_t inputBase = 0x100 + (input * 0x10);
-    uint16_t potValue = analogRead(conf[inputBase + 1]);
+    uint8_t pin = conf.inputs[input].pin;
+    uint16_t potValue = analogRead(pin);
     uint16_t potValuePrev = potValue;
     uint16_t potMin = potValue;
     uint16_t potMax = potValue;
@@ -184,7 +308,7 @@ uint16_t* minmaxInput(uint8_t input) {
         if (millisNow - millisPrev >= 40) {
             millisPrev = millisNow;
 
-            potValue = analogRead(conf[inputBase + 1]);
+            potValue = analogRead(pin);
             if (potValue != potValuePrev) {
                 potValuePrev = potValue;
 
@@ -208,12 +332,14 @@ uint16_t* minmaxInput(uint8_t input) {
         Serial.read();
     }
 
-    static uint16_t values[2] = {potMin, potMax};
+    static uint16_t values[2];
+    values[0] = potMin;
+    values[1] = potMax;
     return values;
 }
 
 void configInput(uint8_t number) {
-    uint16_t inputBase = 0x100 + (number * 0x10);
+    conf_input_t &record = conf.inputs[number];
     uint8_t teensyPins[16] = {0, 1, 2, 3, 6, 7, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21};
 
     Serial.print("---- Configure Input #");
@@ -221,75 +347,230 @@ void configInput(uint8_t number) {
     Serial.println(" ----");
     Serial.println(getInputName(number));
 
-    conf[inputBase + 1] = teensyPins[number];  // Pin
+    record.pin = teensyPins[number];
 
     Serial.print("\nEnabled 0-1: ");
-    conf[inputBase] = getInt();  // Enabled
+    record.enabled = getInt();
 
     Serial.println("Set Min / Max for input, 'a' to accept...");
-    uint16_t* MinMax = minmaxInput(conf[inputBase + 1]);
-    uint16_t potMin = MinMax[0];
-    uint16_t potMax = MinMax[1];
-    conf[inputBase + 3] = (potMin & 0xFF00) >> 8;  // Min High
-    conf[inputBase + 2] = (potMin & 0x00FF);  // Min Low
-    conf[inputBase + 5] = (potMax & 0xFF00) >> 8;  // Max High
-    conf[inputBase + 4] = (potMax & 0x00FF);  // Max Low
+    uint16_t* MinMax = minmaxInput(number);
+    record.min = MinMax[0];
+    record.max = MinMax[1];
+
+    curve_t &curve = conf.curves[number];
+    memset(&curve, 0, sizeof(curve));
+
+    Serial.print("Curve points between min and max 0-4 (0 = straight line): ");
+    uint8_t points = min(getInt(), (uint32_t)CURVE_POINTS);
+
+    for (uint8_t p = 0; p < points; p++) {
+        Serial.print("Hold the input at point ");
+        Serial.print(p + 1);
+        Serial.print(" and enter its value 0-255: ");
+        curve.value[p] = min(getInt(), (uint32_t)255);
+        curve.reading[p] = analogRead(record.pin);
+
+        Serial.print("Reading: ");
+        Serial.println(curve.reading[p]);
+    }
 
     processInputs();
 }
 
 void configServo(uint8_t number) {
-    uint16_t servoBase = 0x200 + (number * 0x10);
+    conf_servo_t &record = servoRecord(number);
 
     Serial.print("\n---- Configure Servo #");
     Serial.print(number);
     Serial.println(" ----");
     Serial.println(getServoName(number));
 
-    conf[servoBase + 1] = number;  // Pin
+    record.pin = number;
 
     Serial.print("\nEnabled 0-1: ");
-    conf[servoBase] = getInt();  // Enabled
+    record.enabled = getInt();
 
     printInputs();
 	Serial.print("Which input would you like to use 0-15: ");
-    conf[servoBase + 6] = getInt();  // Input
-    Serial.println(getInputName(conf[servoBase + 6]));
+    record.input = getInt();
+    Serial.println(getInputName(record.input));
 
     Serial.print("Invert 0-1: ");
-    conf[servoBase + 7] = getInt();  // Invert
+    record.invert = getInt();
 
     Serial.println("\n\nSet Min for servo, 'a' to accept...");
-    uint16_t min = minmaxServo(conf[servoBase + 6], conf[servoBase + 1]);
-    conf[servoBase + 3] = (min & 0xFF00) >> 8;  // Min High
-    conf[servoBase + 2] = (min & 0x00FF);  // Min Low
+    record.min = minmaxServo(record.input, record.pin);
 
     Serial.println("\n\nSet Max for servo, 'a' to accept...");
-    uint16_t max = minmaxServo(conf[servoBase + 6], conf[servoBase + 1]);
-    conf[servoBase + 5] = (max & 0xFF00) >> 8;  // Max High
-    conf[servoBase + 4] = (max & 0x00FF);  // Max Low
+    record.max = minmaxServo(record.input, record.pin);
 
     processServos();
 }
 
+void configBoards() {
+    Serial.println("\n---- Configure Servo Boards ----");
+
+    Serial.print("Number of boards 1-4: ");
+    conf.boardCount = constrain(getInt(), 1, MAX_BOARDS);
+
+    for (uint8_t b = 0; b < conf.boardCount; b++) {
+        Serial.print("Board #");
+        Serial.print(b);
+        Serial.print(" I2C address (64 = 0x40): ");
+        conf.boardAddress[b] = getInt();
+
+        // Boards on different ports are sent at the same time
+        Serial.print("Board #");
+        Serial.print(b);
+        Serial.print(" I2C port 0-Wire 1-Wire1 2-Wire2: ");
+        conf.boardBus[b] = min(getInt(), (uint32_t)(I2C_BUSES - 1));
+    }
+
+    conf.version = CONF_VERSION;
+}
+
+void configSync() {
+    Serial.print("\nSync 0-Off 1-Master 2-Follower: ");
+    conf.syncRole = getInt();
+
+    setupSync();
+}
+
+void configLipsync() {
+    Serial.println("\n---- Configure Lip Sync ----");
+
+    Serial.print("Mode 0-Off 1-Live 2-Bake into new shows: ");
+    conf.lipsync.mode = getInt();
+
+    printServos();
+    Serial.print("Mouth servo 0-63: ");
+    conf.lipsync.servo = getInt();
+
+    Serial.print("Attack ms 0-255: ");
+    conf.lipsync.attack = getInt();
+
+    Serial.print("Release ms 0-255: ");
+    conf.lipsync.release = getInt();
+
+    Serial.print("Servo lag ms 0-255: ");
+    conf.lipsync.lead = getInt();
+
+    Serial.print("Gain 1-255 (16 = 1x): ");
+    conf.lipsync.gain = getInt();
+
+    setupLipsync();
+}
+
+void configIdle() {
+    Serial.println("\n---- Configure Idle ----");
+
+    Serial.print("Crossfade into a show, frames 0-255 (0 = snap): ");
+    conf.idle.blend = getInt();
+
+    Serial.print("Idle motion, % of servo range 0-100 (0 = off): ");
+    conf.idle.amplitude = min(getInt(), 100);
+
+    printServos();
+    Serial.print("Blink servo 0-63 (255 = none): ");
+    conf.idle.blinkServo = getInt();
+}
+
+void configTrigger() {
+    Serial.println("\n---- Configure Trigger ----");
+
+    Serial.print("Trigger 0-Off 1-Rising edge 2-Falling edge: ");
+    conf.trigger.mode = getInt();
+
+    Serial.print("Trigger pin: ");
+    conf.trigger.pin = getInt();
+
+    Serial.print("Trigger while playing 0-Ignore 1-Restart: ");
+    conf.trigger.retrigger = getInt();
+
+    Serial.print("Show select pins 0-8 (0 = select over serial): ");
+    conf.trigger.selectBits = min(getInt(), 8);
+
+    if (conf.trigger.selectBits > 0) {
+        Serial.print("First show select pin: ");
+        conf.trigger.selectPin = getInt();
+    }
+
+    setupTrigger();
+}
+
+void configOutput(uint8_t number) {
+    Serial.print("\n---- Configure Output #");
+    Serial.print(number);
+    Serial.println(" ----");
+
+    Serial.print("Pin: ");
+    conf.outputs[number].pin = getInt();
+
+    Serial.print("Mode 0-Disabled 1-Digital 2-PWM: ");
+    conf.outputs[number].mode = getInt();
+
+    setupOutputs();
+}
+
+void configProfile(uint8_t number) {
+    profile_t &p = conf.profiles[number];
+
+    Serial.print("\n---- Configure Servo #");
+    Serial.print(number);
+    Serial.println(" Motion Limits ----");
+    Serial.println(getServoName(number));
+    Serial.println("0 turns a limit off");
+
+    Serial.print("Max velocity, ticks per frame 0-255: ");
+    p.velocity = getInt();
+
+    Serial.print("Max acceleration, 1/4 ticks per frame per frame 0-255: ");
+    p.accel = getInt();
+
+    Serial.print("Max jerk, 1/16 ticks per frame per frame per frame 0-255: ");
+    p.jerk = getInt();
+
+    reloadServos();
+}
+
+void configLatency(uint8_t number) {
+    latency_t &l = conf.latency[number];
+
+    Serial.print("\n---- Configure Servo #");
+    Serial.print(number);
+    Serial.println(" Latency ----");
+    Serial.println(getServoName(number));
+    Serial.print("1 frame = ");
+    Serial.print(SAMPLE_RATE);
+    Serial.println("ms");
+
+    Serial.print("Playback lead, frames the servo lags behind its track 0-255: ");
+    l.play = getInt();
+
+    Serial.print("Record lag, frames the puppeteer lags behind the audio 0-255: ");
+    l.record = getInt();
+
+    reloadServos();
+}
+
 void invertServo(uint8_t number) {
-    uint16_t servoBase = 0x200 + (number * 0x10);
-    uint8_t value = conf[servoBase + 7];
+    conf_servo_t &record = servoRecord(number);
 
-    if (value == 1) {
-        conf[servoBase + 7] = 0;
+    if (record.invert == 1) {
+        record.invert = 0;
     } else {
-        conf[servoBase + 7] = 1;
+        record.invert = 1;
     }
 
+    reloadServos();
+
     Serial.print("Servo #");
     Serial.print(number);
     Serial.println(" inverted");
 }
 
 void filterServo(uint8_t number) {
-    uint16_t servoFilterBase = 0x300 + number;
-    uint8_t currentValue = conf[servoFilterBase];
+    uint8_t currentValue = servoFilter(number);
 
     Serial.print("---- Configure Servo #");
     Serial.print(number);
@@ -302,30 +583,31 @@ void filterServo(uint8_t number) {
 	Serial.print("Set new filter value: ");
 	uint8_t newValue = getInt();
 
-    conf[servoFilterBase] = newValue;
+    servoFilter(number) = newValue;
+    reloadServos();
 }
 
 void toggleServo(uint8_t number) {
-    uint16_t servoBase = 0x200 + (number * 0x10);
-    uint8_t value = conf[servoBase];
+    conf_servo_t &record = servoRecord(number);
 
     Serial.print("Servo #");
     Serial.print(number);
 
-    if (value == 1) {
-        conf[servoBase + 7] = 0;
+    if (record.enabled == 1) {
+        record.enabled = 0;
         Serial.println(" disabled");
     } else {
-        conf[servoBase + 7] = 1;
+        record.enabled = 1;
         Serial.println(" enabled");
     }
+
+    reloadServos();
 }
 
 void printServos() {
 	Serial.println();
-	for (int s = 0; s < 16; s++ ) {
-		uint16_t servoBase = 0x200 + (s * 0x10);
-		uint8_t enabled = conf[servoBase];
+	for (int s = 0; s < getBoardCount() * 16; s++ ) {
+		uint8_t enabled = servoRecord(s).enabled;
 		if (enabled) {
 			Serial.print(s);
 			Serial.print(": ");
@@ -337,8 +619,7 @@ void printServos() {
 void printInputs() {
 	Serial.println();
 	for (int i = 0; i < 16; i++ ) {
-		uint16_t inputBase = 0x100 + (i * 0x10);
-		uint8_t enabled = conf[inputBase];
+		uint8_t enabled = conf.inputs[i].enabled;
 		if (enabled) {
 			Serial.print(i);
 			Serial.print(": ");
@@ -6,9 +6,68 @@
 #ifndef CONFIG_H_
     #define CONFIG_H_
 
+    #include "events.h"
+    #include "idle.h"
+    #include "lipsync.h"
     #include "servo.h"
+    #include "trigger.h"
     #include <Arduino.h>
 
+    /**
+    *   @brief  Struct for an input record in the config file
+    */
+    struct __attribute__((packed)) conf_input_t {
+        uint8_t enabled;
+        uint8_t pin;
+        uint16_t min;
+        uint16_t max;
+        uint8_t reserved[2];
+        char name[8];
+    };
+
+    /**
+    *   @brief  Struct for a servo record in the config file
+    */
+    struct __attribute__((packed)) conf_servo_t {
+        uint8_t enabled;
+        uint8_t pin;
+        uint16_t min;
+        uint16_t max;
+        uint8_t input;
+        uint8_t invert;
+        char name[8];
+    };
+
+    /**
+    *   @brief  Struct for the config file, read and written as one block
+    *
+    *   New fields go in a reserved range and must treat 0 as their default, so a file
+    *   saved by older firmware loads with every new field at its default.
+    */
+    struct __attribute__((packed)) config_t {
+        char name[16];
+        uint8_t version;
+        uint8_t boardCount;
+        uint8_t boardAddress[MAX_BOARDS];
+        uint8_t syncRole;
+        lipsync_t lipsync;
+        idle_t idle;
+        output_t outputs[OUTPUT_COUNT];
+        trigger_t trigger;
+        uint8_t boardBus[MAX_BOARDS];  // 0 is the Wire port, so older files keep every board there
+        uint8_t reserved1[0x07];
+        curve_t curves[16];
+        conf_input_t inputs[16];
+        conf_servo_t servosLow[16];  // Servos 0-15
+        uint8_t filtersLow[16];
+        latency_t latency[MAX_SERVOS];
+        uint8_t reserved2[0x70];
+        conf_servo_t servosHigh[MAX_SERVOS - 16];  // Servos 16-63, config version 2
+        uint8_t filtersHigh[MAX_SERVOS - 16];
+        uint8_t reserved3[0x10];
+        profile_t profiles[MAX_SERVOS];
+    };
+
     /**
     *   @brief  Load the config file from SD card
     */
@@ -19,6 +78,11 @@
     */
     void saveConfig(void);
 
+    /**
+    *   @brief  Load the config file again and apply it to the running servos without centering them
+    */
+    void reloadConfig(void);
+
     /**
     *   @brief  Get the figure name from the config file
     *
@@ -45,7 +109,7 @@
     /**
     *   @brief  Get the servo name for a given number from the config file
     *
-    *   @param  number  Servo number, 0 ... 15
+    *   @param  number  Servo number, 0 ... 63
     *   @return Returns the servo name for a given number as a char[8]
     */
     char* getServoName(uint8_t number);
@@ -53,7 +117,7 @@
     /**
     *   @brief  Set the servo name for a given number from the config file
     *
-    *   @param  number  Servo number, 0 ... 15
+    *   @param  number  Servo number, 0 ... 63
     *   @param  name    Servo name, char[8]
     */
     void setServoName(uint8_t number, char* name);
@@ -69,15 +133,98 @@
     /**
     *   @brief  Get the servo data for a given servo number
     *
-    *   @param  number  Servo number, 0 ... 15
+    *   @param  number  Servo number, 0 ... 63
     *   @return Returns a servo_t struct
     */
     servo_t getServoData(uint8_t number);
 
+    /**
+    *   @brief  Get the calibration curve for a given input number
+    *
+    *   @param  number  Input number, 0 ... 15
+    *   @return Returns a curve_t struct
+    */
+    curve_t getCurveData(uint8_t number);
+
+    /**
+    *   @brief  Get the motion profile for a given servo number
+    *
+    *   @param  number  Servo number, 0 ... 63
+    *   @return Returns a profile_t struct
+    */
+    profile_t getProfileData(uint8_t number);
+
+    /**
+    *   @brief  Get the playback lead and record lag for a given servo number
+    *
+    *   @param  number  Servo number, 0 ... 63
+    *   @return Returns a latency_t struct
+    */
+    latency_t getLatencyData(uint8_t number);
+
+    /**
+    *   @brief  Get the number of chained servo boards from the config file
+    *
+    *   @return Returns the number of servo boards, 1 ... 4
+    */
+    uint8_t getBoardCount(void);
+
+    /**
+    *   @brief  Get the I2C address of a given servo board
+    *
+    *   @param  board   Board number, 0 ... 3
+    *   @return Returns the I2C address of the board, default 0x40 + board
+    */
+    uint8_t getBoardAddress(uint8_t board);
+
+    /**
+    *   @brief  Get the I2C port a given servo board is wired to
+    *
+    *   @param  board   Board number, 0 ... 3
+    *   @return Returns the port, 0 Wire | 1 Wire1 | 2 Wire2, default 0
+    */
+    uint8_t getBoardBus(uint8_t board);
+
+    /**
+    *   @brief  Get the timecode role from the config file
+    *
+    *   @return Returns 0 off, 1 master or 2 follower
+    */
+    uint8_t getSyncConfig(void);
+
+    /**
+    *   @brief  Get the lip sync settings from the config file
+    *
+    *   @return Returns a lipsync_t struct
+    */
+    lipsync_t getLipsyncData(void);
+
+    /**
+    *   @brief  Get the idle motion and crossfade settings from the config file
+    *
+    *   @return Returns an idle_t struct
+    */
+    idle_t getIdleData(void);
+
+    /**
+    *   @brief  Get the trigger settings from the config file
+    *
+    *   @return Returns a trigger_t struct
+    */
+    trigger_t getTriggerData(void);
+
+    /**
+    *   @brief  Get the output data for a given output number
+    *
+    *   @param  number  Output number, 0 ... 7
+    *   @return Returns a output_t struct
+    */
+    output_t getOutputData(uint8_t number);
+
     /**
     *   @brief  Get the center position for a given servo
     *
-    *   @param  number  Servo number, 0 ... 15
+    *   @param  number  Servo number, 0 ... 63
     *   @return Returns a uint16_t for the center position of a given servo
     */
     uint16_t getServoCenter(uint8_t number);
@@ -100,28 +247,74 @@
     /**
     *   @brief  Configure a given servo
     *
-    *   @param  number  Servo number, 0 ... 15
+    *   @param  number  Servo number, 0 ... 63
     */
     void configServo(uint8_t number);
 
+    /**
+    *   @brief  Configure the number and I2C addresses of the servo boards
+    */
+    void configBoards(void);
+
+    /**
+    *   @brief  Configure the timecode role of this controller
+    */
+    void configSync(void);
+
+    /**
+    *   @brief  Configure the lip sync servo and envelope
+    */
+    void configLipsync(void);
+
+    /**
+    *   @brief  Configure the idle motion between shows and the crossfade into a show
+    */
+    void configIdle(void);
+
+    /**
+    *   @brief  Configure the show trigger and show select pins
+    */
+    void configTrigger(void);
+
+    /**
+    *   @brief  Configure a given event output
+    *
+    *   @param  number  Output number, 0 ... 7
+    */
+    void configOutput(uint8_t number);
+
+    /**
+    *   @brief  Configure the velocity, acceleration and jerk limits of a given servo
+    *
+    *   @param  number  Servo number, 0 ... 63
+    */
+    void configProfile(uint8_t number);
+
+    /**
+    *   @brief  Configure the playback lead and record lag of a given servo
+    *
+    *   @param  number  Servo number, 0 ... 63
+    */
+    void configLatency(uint8_t number);
+
     /**
     *   @brief  Invert a given servo
     *
-    *   @param  number  Servo number, 0 ... 15
+    *   @param  number  Servo number, 0 ... 63
     */
     void invertServo(uint8_t number);
 	
     /**
     *   @brief  Change filter value for a given servo
     *
-    *   @param  number  Servo number, 0 ... 15
+    *   @param  number  Servo number, 0 ... 63
     */
 	void filterServo(uint8_t number);
 
     /**
     *   @brief  Enable/Disable a given servo
     *
-    *   @param  number  Servo number, 0 ... 15
+    *   @param  number  Servo number, 0 ... 63
     */
     void toggleServo(uint8_t number);
 	
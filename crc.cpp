@@ -0,0 +1,39 @@
+/**
+*   @file   crc.cpp
+*   @brief  Functions for computing CRC-32 checksums
+*/
+
+#include "crc.h"
+
+#define CRC32_POLYNOMIAL 0xEDB88320  // Reflected IEEE 802.3, same as zip and PNG
+
+uint32_t crcTable[256];
+bool crcTableReady = false;
+
+void buildCrcTable() {
+    for (uint16_t i = 0; i < 256; i++) {
+        uint32_t value = i;
+
+        for (uint8_t b = 0; b < 8; b++) {
+            value = (value & 1) ? ((value >> 1) ^ CRC32_POLYNOMIAL) : (value >> 1);
+        }
+
+        crcTable[i] = value;
+    }
+
+    crcTableReady = true;
+}
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, uint32_t size) {
+    if (!crcTableReady) {
+        buildCrcTable();
+    }
+
+    crc = ~crc;
+
+    while (size-- > 0) {
+        crc = crcTable[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
@@ -0,0 +1,25 @@
+/**
+*   @file   crc.h
+*   @brief  Functions for computing CRC-32 checksums
+*/
+
+#ifndef CRC_H_
+    #define CRC_H_
+
+    #ifdef ARDUINO
+        #include <Arduino.h>
+    #else
+        #include <stdint.h>
+    #endif
+
+    /**
+    *   @brief  Add data to a CRC-32, start with a crc of 0 and pass the result back in to continue
+    *
+    *   @param  crc     CRC-32 of the data so far, 0 to start
+    *   @param  data    Data to add
+    *   @param  size    Number of bytes to add
+    *   @return Returns the CRC-32 of all data added so far
+    */
+    uint32_t crc32(uint32_t crc, const uint8_t* data, uint32_t size);
+
+#endif  // CRC_H_
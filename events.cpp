@@ -0,0 +1,190 @@
+/**
+*   @file   events.cpp
+*   @brief  Functions for the show event track, timed relay, light and smoke outputs
+*
+*   Events are stored in the show file as an "EVNT" chunk after the show data,
+*   6 bytes per event: ms (uint32 little endian), output, value.
+*/
+
+#include "events.h"
+#include "config.h"
+#include "layout.h"
+#include "show.h"
+#include "storage.h"
+
+
+output_t output[OUTPUT_COUNT];
+event_t events[MAX_EVENTS];
+uint16_t eventCount = 0;
+uint16_t eventCursor = 0;
+
+void setupOutputs() {
+    for (uint8_t o = 0; o < OUTPUT_COUNT; o++) {
+        output[o] = getOutputData(o);
+
+        if (output[o].mode != 0) {
+            pinMode(output[o].pin, OUTPUT);
+            digitalWrite(output[o].pin, LOW);
+        }
+    }
+}
+
+void clearEvents() {
+    eventCount = 0;
+    eventCursor = 0;
+}
+
+bool addEvent(uint32_t ms, uint8_t number, uint8_t value) {
+    if (eventCount >= MAX_EVENTS || number >= OUTPUT_COUNT) {
+        return false;
+    }
+
+    uint16_t e = eventCount;
+
+    while (e > 0 && events[e - 1].ms > ms) {
+        events[e] = events[e - 1];
+        e--;
+    }
+
+    events[e].ms = ms;
+    events[e].output = number;
+    events[e].value = value;
+    eventCount++;
+
+    markChunksDirty();
+
+    return true;
+}
+
+uint16_t getEventCount() {
+    return eventCount;
+}
+
+uint16_t findEvent(uint32_t ms) {
+    uint16_t low = 0;
+    uint16_t high = eventCount;
+
+    while (low < high) {
+        uint16_t middle = (low + high) / 2;
+
+        if (events[middle].ms < ms) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+void seekEvents(uint32_t ms) {
+    eventCursor = findEvent(ms);
+}
+
+void seekEventsFrom(uint16_t index, uint32_t ms) {
+    eventCursor = min(index, eventCount);
+
+    while (eventCursor < eventCount && events[eventCursor].ms < ms) {
+        eventCursor++;
+    }
+}
+
+uint16_t playEvents(uint32_t ms) {
+    uint16_t fired = 0;
+
+    while (eventCursor < eventCount && events[eventCursor].ms < ms) {
+        event_t e = events[eventCursor];
+        output_t o = output[e.output];
+
+        if (o.mode == 1) {
+            digitalWrite(o.pin, e.value ? HIGH : LOW);
+        } else if (o.mode == 2) {
+            analogWrite(o.pin, e.value);
+        }
+
+        eventCursor++;
+        fired++;
+    }
+
+    return fired;
+}
+
+bool loadEvents(File &file, uint32_t size) {
+    uint8_t data[EVENT_BYTE_SIZE];
+    bool asStored = true;
+
+    clearEvents();
+
+    while (size >= EVENT_BYTE_SIZE && eventCount < MAX_EVENTS) {
+        if (file.read(data, EVENT_BYTE_SIZE) != EVENT_BYTE_SIZE) {
+            break;
+        }
+
+        size -= EVENT_BYTE_SIZE;
+
+        uint32_t ms = (data[3] << 24) + (data[2] << 16) + (data[1] << 8) + data[0];
+
+        // An event for an output that does not exist would index past output[] when it plays
+        if (data[4] >= OUTPUT_COUNT) {
+            asStored = false;
+            continue;
+        }
+
+        // findEvent() searches by time, so an event out of order is moved back to its place
+        uint16_t e = eventCount;
+
+        while (e > 0 && events[e - 1].ms > ms) {
+            events[e] = events[e - 1];
+            e--;
+        }
+
+        if (e < eventCount) {
+            asStored = false;
+        }
+
+        events[e].ms = ms;
+        events[e].output = data[4];
+        events[e].value = data[5];
+        eventCount++;
+    }
+
+    if (size > 0) {
+        file.seek(file.position() + size);
+    }
+
+    return asStored;
+}
+
+bool saveEvents() {
+    if (eventCount == 0) {
+        return true;
+    }
+
+    if (!writeChunkHeader(CHUNK_EVENTS, eventCount * EVENT_BYTE_SIZE)) {
+        return false;
+    }
+
+    for (uint16_t e = 0; e < eventCount; e++) {
+        uint8_t data[EVENT_BYTE_SIZE] = {
+            (uint8_t)(events[e].ms & 0xFF), (uint8_t)((events[e].ms >> 8) & 0xFF),
+            (uint8_t)((events[e].ms >> 16) & 0xFF), (uint8_t)(events[e].ms >> 24),
+            events[e].output, events[e].value};
+
+        if (!writeSave(data, EVENT_BYTE_SIZE)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void printEvents() {
+    Serial.println();
+    for (uint16_t e = 0; e < eventCount; e++) {
+        Serial.print(events[e].ms);
+        Serial.print("ms: Output ");
+        Serial.print(events[e].output);
+        Serial.print(" = ");
+        Serial.println(events[e].value);
+    }
+}
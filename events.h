@@ -0,0 +1,111 @@
+/**
+*   @file   events.h
+*   @brief  Functions for the show event track, timed relay, light and smoke outputs
+*/
+
+#ifndef EVENTS_H_
+    #define EVENTS_H_
+
+    #include <Arduino.h>
+    #include <SD.h>
+
+    #define MAX_EVENTS 512
+    #define OUTPUT_COUNT 8
+
+    /**
+    *   @brief  Struct for Output settings
+    */
+    struct output_t {
+        uint8_t pin;
+        uint8_t mode;  // 0 disabled | 1 digital | 2 PWM
+    };
+
+    /**
+    *   @brief  Struct for a single show event, stored time sorted in the event track
+    */
+    struct event_t {
+        uint32_t ms;
+        uint8_t output;
+        uint8_t value;
+    };
+
+    /**
+    *   @brief  Setup the event outputs from the config file
+    */
+    void setupOutputs(void);
+
+    /**
+    *   @brief  Remove all events from the event track
+    */
+    void clearEvents(void);
+
+    /**
+    *   @brief  Add an event to the event track, keeping the track time sorted
+    *
+    *   @param  ms      Show time to fire the event in milliseconds, 0 ... 4294967295
+    *   @param  output  Output number, 0 ... 7
+    *   @param  value   Output value, 0 ... 255
+    *   @return ```true``` if the event was added and ```false``` if the track is full
+    */
+    bool addEvent(uint32_t ms, uint8_t output, uint8_t value);
+
+    /**
+    *   @brief  Get the number of events in the event track
+    *
+    *   @return Returns the number of events, 0 ... MAX_EVENTS
+    */
+    uint16_t getEventCount(void);
+
+    /**
+    *   @brief  Find the first event at or after a given show time with a binary search
+    *
+    *   @param  ms  Show time in milliseconds, 0 ... 4294967295
+    *   @return Returns the index of the event, 0 ... MAX_EVENTS
+    */
+    uint16_t findEvent(uint32_t ms);
+
+    /**
+    *   @brief  Move the event cursor to the first event at or after a given show time
+    *
+    *   @param  ms  Show time in milliseconds, 0 ... 4294967295
+    */
+    void seekEvents(uint32_t ms);
+
+    /**
+    *   @brief  Move the event cursor forward from a known index, used with the show block index
+    *
+    *   @param  index   Event index at or before the show time, 0 ... MAX_EVENTS
+    *   @param  ms      Show time in milliseconds, 0 ... 4294967295
+    */
+    void seekEventsFrom(uint16_t index, uint32_t ms);
+
+    /**
+    *   @brief  Fire every event before a given show time and advance the event cursor
+    *
+    *   @param  ms  Show time at the end of the current frame in milliseconds, 0 ... 4294967295
+    *   @return Returns the number of events fired, 0 ... MAX_EVENTS
+    */
+    uint16_t playEvents(uint32_t ms);
+
+    /**
+    *   @brief  Load the event track from an open show file, events for outputs that do not exist are skipped and the rest sorted by time
+    *
+    *   @param  file    Show file positioned at the start of the event data
+    *   @param  size    Size of the event data in bytes
+    *   @return ```true``` if the events were kept as stored and ```false``` if any were skipped or moved
+    */
+    bool loadEvents(File &file, uint32_t size);
+
+    /**
+    *   @brief  Write the event track to the open save
+    *
+    *   @return ```true``` if the events were written and ```false``` if there was an error
+    */
+    bool saveEvents(void);
+
+    /**
+    *   @brief  Prints a list of all events in the event track
+    */
+    void printEvents(void);
+
+#endif  // EVENTS_H_
@@ -0,0 +1,130 @@
+/**
+*   @file   idle.cpp
+*   @brief  Functions for the idle motion between shows and the crossfade into the next show
+*
+*   Each servo breathes on a slow sine with its own phase and drifts between random targets,
+*   and the blink servo closes for a few frames at random intervals. Everything is integer
+*   math on the 0 ... 255 show scale, so the servos' filters, limits and motion profiles apply.
+*/
+
+#include "idle.h"
+#include "config.h"
+#include "sdio.h"
+#include "servo.h"
+#include "show.h"
+
+#define IDLE_FRAME_US (SAMPLE_RATE * 1000)
+#define IDLE_BREATH_FRAMES (4000 / SAMPLE_RATE)  // One breath every 4s
+#define IDLE_DRIFT_FRAMES (2500 / SAMPLE_RATE)  // New drift target every 2.5s
+#define IDLE_BLINK_FRAMES (150 / SAMPLE_RATE)  // Eyes closed for 150ms
+#define IDLE_BLINK_MIN_FRAMES (2000 / SAMPLE_RATE)  // 2 ... 6s between blinks
+#define IDLE_BLINK_SPAN_FRAMES (4000 / SAMPLE_RATE)
+
+bool idleRunning = false;
+uint32_t idleFrame = 0;
+uint32_t idleMicrosPrev = 0;
+uint32_t idleNextBlink = 0;
+uint32_t idleSeed = 0x1234567;
+int8_t driftFrom[MAX_SERVOS];
+int8_t driftTo[MAX_SERVOS];
+
+/**
+*   @brief  Xorshift random number
+*
+*   @return Returns the next random number, 0 ... 4294967295
+*/
+uint32_t idleRandom() {
+    idleSeed ^= idleSeed << 13;
+    idleSeed ^= idleSeed >> 17;
+    idleSeed ^= idleSeed << 5;
+    return idleSeed;
+}
+
+/**
+*   @brief  Parabolic sine
+*
+*   @param  phase   Phase, 0 ... 65535 is one cycle
+*   @return Returns the sine scaled to -128 ... 128
+*/
+int16_t idleSine(uint16_t phase) {
+    int32_t x = (int16_t)phase;
+    return (x * (32768 - abs(x))) >> 21;
+}
+
+void startIdle() {
+    idle_t settings = getIdleData();
+
+    if (idleRunning || settings.amplitude == 0) {
+        return;
+    }
+
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
+        driftFrom[s] = 0;
+        driftTo[s] = 0;
+    }
+
+    idleSeed ^= micros();
+    idleFrame = 0;
+    idleNextBlink = IDLE_BLINK_MIN_FRAMES;
+    idleMicrosPrev = micros() - IDLE_FRAME_US;
+    idleRunning = true;
+
+    beginBlend(settings.blend);
+}
+
+void stopIdle() {
+    idleRunning = false;
+}
+
+void serviceIdle() {
+    serviceIO();  // The tail of the last show's audio can still be playing
+
+    if (!idleRunning) {
+        return;
+    }
+
+    serviceServos();
+
+    uint32_t microsNow = micros();
+
+    if (microsNow - idleMicrosPrev < IDLE_FRAME_US) {
+        return;
+    }
+
+    idleMicrosPrev = (microsNow - idleMicrosPrev < 2 * IDLE_FRAME_US) ? idleMicrosPrev + IDLE_FRAME_US : microsNow;
+
+    idle_t settings = getIdleData();
+    uint8_t servoCount = getServoCount();
+    uint16_t drift = idleFrame % IDLE_DRIFT_FRAMES;
+    bool newDrift = (drift == 0);
+    bool blinking = (idleFrame >= idleNextBlink);
+
+    if (idleFrame >= idleNextBlink + IDLE_BLINK_FRAMES) {
+        idleNextBlink = idleFrame + IDLE_BLINK_MIN_FRAMES + (idleRandom() % IDLE_BLINK_SPAN_FRAMES);
+        blinking = false;
+    }
+
+    for (uint8_t s = 0; s < servoCount; s++) {
+        if (newDrift) {
+            driftFrom[s] = driftTo[s];
+            driftTo[s] = idleRandom();
+        }
+
+        uint8_t value = 0;
+
+        if (!(blinking && s == settings.blinkServo)) {
+            // Every servo has its own breath phase so the figure does not move in lockstep
+            uint16_t phase = (((idleFrame % IDLE_BREATH_FRAMES) * 65536) / IDLE_BREATH_FRAMES) + (s * 9973);
+            int32_t wander = driftFrom[s] + (((driftTo[s] - driftFrom[s]) * (int32_t)drift) / IDLE_DRIFT_FRAMES);
+            int32_t offset = (idleSine(phase) + wander) / 2;
+
+            value = constrain(128 + ((offset * settings.amplitude) / 100), 0, 255);
+        }
+
+        playServoTicks(s, computeServo(s, value));
+    }
+
+    queueServos();
+    stepBlend();
+    idleFrame++;
+}
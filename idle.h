@@ -0,0 +1,40 @@
+/**
+*   @file   idle.h
+*   @brief  Functions for the idle motion between shows and the crossfade into the next show
+*/
+
+#ifndef IDLE_H_
+    #define IDLE_H_
+
+    #include <Arduino.h>
+
+    #define IDLE_NO_BLINK 255
+
+    /**
+    *   @brief  Struct for Idle settings
+    */
+    struct idle_t {
+        uint8_t blend;  // Frames to crossfade from the last pose into a show, 0 snaps
+        uint8_t amplitude;  // % of each servo's half range, 0 turns idle motion off
+        uint8_t blinkServo;  // 0 ... 63, IDLE_NO_BLINK for none
+    };
+
+    /**
+    *   @brief  Start the idle motion from the pose the figure is in, does nothing if it is off or already running
+    */
+    void startIdle(void);
+
+    /**
+    *   @brief  Stop the idle motion, the figure holds its last idle pose
+    */
+    void stopIdle(void);
+
+    /**
+    *   @brief  Send the next idle frame when one is due, call from every loop that waits between shows
+    *
+    *   Cheap enough to call between SD sectors, so the figure keeps moving while the next show loads.
+    *   Also refills the audio ring while the tail of the last show's audio plays.
+    */
+    void serviceIdle(void);
+
+#endif  // IDLE_H_
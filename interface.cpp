@@ -4,6 +4,10 @@
 */
 
 #include "interface.h"
+#include "audio.h"
+#include "show.h"
+#include "telemetry.h"
+#include "trigger.h"
 
 char getChar() {
     while (Serial.available() == 0) {
@@ -49,3 +53,35 @@ char* getString() {
 
     return buffer;
 }
+
+void serviceCommands() {
+    if (Serial.available() <= 0) {
+        return;
+    }
+
+    switch (Serial.read()) {
+        case 's':
+            stopShow();
+            break;
+        case 'p':
+            pauseShow(!isShowPaused());
+            break;
+        case '?':
+            printShowStatus();
+            break;
+        case '+':
+            setVolume(min(getVolume() + 10, 100));
+            break;
+        case '-':
+            setVolume(max(getVolume() - 10, 0));
+            break;
+        case 't':
+            fireTrigger();
+            break;
+        case 'm':
+            setTelemetry(!isTelemetryEnabled());
+            break;
+        default:
+            break;
+    }
+}
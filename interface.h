@@ -29,4 +29,9 @@
     */
     char* getString(void);
 
+    /**
+    *   @brief  Handle one serial command while a show plays, returns straight away if there is none
+    */
+    void serviceCommands(void);
+
 #endif  // INTERFACE_H_
@@ -0,0 +1,197 @@
+/**
+*   @file   layout.h
+*   @brief  Byte layout of the config file and the show file
+*
+*   Every offset is constexpr so accessors fold to a fixed address when the number
+*   is known at compile time, and the static_asserts below catch overlapping tables.
+*   The host tools in tools/ build against this file too, so it must not need Arduino.
+*/
+
+#ifndef LAYOUT_H_
+    #define LAYOUT_H_
+
+    #ifdef ARDUINO
+        #include <Arduino.h>
+    #else
+        #include <stdint.h>
+    #endif
+
+    // ---- Limits shared by the controller and the host tools ----
+    constexpr uint8_t MAX_BOARDS = 4;
+    constexpr uint8_t MAX_SERVOS = MAX_BOARDS * 16;
+    constexpr uint8_t I2C_BUSES = 3;  // Wire, Wire1 and Wire2 of the Teensy 4
+    constexpr uint16_t SAMPLE_RATE = 10;  // ms per frame, 10fps 100ms | 20fps 50ms | 25fps 40ms | 40fps 25ms | 50fps 20ms
+    constexpr uint8_t EVENT_BYTE_SIZE = 6;  // ms uint32_t LE, output, value
+
+    // ---- Config file ----
+    constexpr uint16_t CONF_SIZE = 0x800;
+    constexpr uint16_t CONF_NAME = 0x000;  // char[16]
+    constexpr uint16_t CONF_VERSION_BYTE = 0x010;
+    constexpr uint16_t CONF_BOARD_COUNT = 0x011;
+    constexpr uint16_t CONF_BOARD_ADDRESS = 0x012;  // uint8_t[4]
+    constexpr uint16_t CONF_SYNC_ROLE = 0x016;
+    constexpr uint16_t CONF_LIPSYNC = 0x017;  // mode, servo, attack, release, lead, gain
+    constexpr uint16_t CONF_IDLE = 0x01D;  // blend frames, amplitude, blink servo
+    constexpr uint16_t CONF_OUTPUTS = 0x020;  // 8 * (pin, mode)
+    constexpr uint16_t CONF_OUTPUT_SIZE = 0x02;
+    constexpr uint16_t CONF_TRIGGER = 0x030;  // mode, pin, retrigger, select pin, select bits
+    constexpr uint16_t CONF_BOARD_BUS = 0x035;  // uint8_t[4] 0 Wire pins 18/19 | 1 Wire1 pins 16/17 | 2 Wire2 pins 24/25
+    constexpr uint16_t CONF_CURVES = 0x040;  // Inputs 0-15, 4 * uint16_t LE reading then 4 * value
+    constexpr uint16_t CONF_CURVE_SIZE = 0x0C;
+    constexpr uint16_t CONF_INPUTS = 0x100;
+    constexpr uint16_t CONF_INPUT_SIZE = 0x10;
+    constexpr uint16_t CONF_SERVOS_LOW = 0x200;  // Servos 0-15
+    constexpr uint16_t CONF_FILTERS_LOW = 0x300;
+    constexpr uint16_t CONF_LATENCY = 0x310;  // Servos 0-63, playback lead frames, record lag frames
+    constexpr uint16_t CONF_LATENCY_SIZE = 0x02;
+    constexpr uint16_t CONF_SERVOS_HIGH = 0x400;  // Servos 16-63, added in config version 2
+    constexpr uint16_t CONF_FILTERS_HIGH = 0x700;
+    constexpr uint16_t CONF_SERVO_SIZE = 0x10;
+    constexpr uint16_t CONF_PROFILES = 0x740;  // Servos 0-63, velocity, acceleration, jerk
+    constexpr uint16_t CONF_PROFILE_SIZE = 0x03;
+
+    // Input and servo record fields
+    constexpr uint8_t FIELD_ENABLED = 0;
+    constexpr uint8_t FIELD_PIN = 1;
+    constexpr uint8_t FIELD_MIN = 2;  // uint16_t LE
+    constexpr uint8_t FIELD_MAX = 4;  // uint16_t LE
+    constexpr uint8_t FIELD_INPUT = 6;  // Servo only
+    constexpr uint8_t FIELD_INVERT = 7;  // Servo only
+    constexpr uint8_t FIELD_NAME = 8;  // char[8]
+
+    // ---- Show file ----
+    constexpr uint32_t SHOW_SIZE = 0x10000;
+    constexpr uint16_t SHOW_HEADER = 0xFFE0;  // Servo tracks end here
+    constexpr uint16_t SHOW_NUMBER = 0xFFE0;
+    constexpr uint16_t SHOW_MS = 0xFFE1;  // uint32_t LE
+    constexpr uint16_t SHOW_VERSION_BYTE = 0xFFE5;
+    constexpr uint16_t SHOW_MAGIC = 0xFFE8;  // uint8_t[8]
+    constexpr uint16_t SHOW_NAME = 0xFFF0;  // char[16]
+    constexpr uint8_t SHOW_MAGIC_DATA[8] = {0xA9, 0x32, 0x30, 0x31, 0x39, 0x20, 0x43, 0x43};
+    constexpr uint8_t SHOW_VERSION = 2;  // 0 show data only | 1 show data followed by chunks | 2 tracks packed by a RATE chunk
+
+    // ---- Show chunks, after the show data: char[4] tag, uint32_t LE size, data ----
+    constexpr uint8_t CHUNK_HEADER_SIZE = 8;
+    constexpr char CHUNK_EVENTS[] = "EVNT";  // 6 bytes per event: ms uint32_t LE, output, value
+    constexpr char CHUNK_INDEX[] = "BIDX";  // uint16_t LE first event of each block of INDEX_BLOCK_FRAMES frames
+    constexpr char CHUNK_RATES[] = "RATE";  // uint8_t[64] frames per stored sample of each servo track
+    constexpr char CHUNK_CRCS[] = "BCRC";  // uint32_t LE CRC-32 of each block of servo tracks
+    constexpr uint16_t INDEX_BLOCK_FRAMES = 256;
+    constexpr uint16_t CRC_BLOCK_SIZE = 512;  // One SD sector
+    constexpr uint8_t CRC_BLOCKS = (SHOW_HEADER + CRC_BLOCK_SIZE - 1) / CRC_BLOCK_SIZE;
+
+    /**
+    *   @brief  Get the config address of a given input
+    *
+    *   @param  number  Input number, 0 ... 15
+    *   @return Returns the address of the input record
+    */
+    constexpr uint16_t confInput(uint8_t number) {
+        return CONF_INPUTS + (number * CONF_INPUT_SIZE);
+    }
+
+    /**
+    *   @brief  Get the config address of a given servo
+    *
+    *   @param  number  Servo number, 0 ... 63
+    *   @return Returns the address of the servo record
+    */
+    constexpr uint16_t confServo(uint8_t number) {
+        return (number < 16) ? CONF_SERVOS_LOW + (number * CONF_SERVO_SIZE) : CONF_SERVOS_HIGH + ((number - 16) * CONF_SERVO_SIZE);
+    }
+
+    /**
+    *   @brief  Get the config address of the filter of a given servo
+    *
+    *   @param  number  Servo number, 0 ... 63
+    *   @return Returns the address of the filter byte
+    */
+    constexpr uint16_t confFilter(uint8_t number) {
+        return (number < 16) ? CONF_FILTERS_LOW + number : CONF_FILTERS_HIGH + (number - 16);
+    }
+
+    /**
+    *   @brief  Get the config address of a given event output
+    *
+    *   @param  number  Output number, 0 ... 7
+    *   @return Returns the address of the output record
+    */
+    constexpr uint16_t confOutput(uint8_t number) {
+        return CONF_OUTPUTS + (number * CONF_OUTPUT_SIZE);
+    }
+
+    /**
+    *   @brief  Get the show address of a frame of a servo track, tracks are stored one after another
+    *
+    *   Only holds while every track stores every frame, a RATE chunk packs slower tracks shorter
+    *
+    *   @param  frame       Frame number, 0x0000 ... 0xFFE0
+    *   @param  maxFrames   Frames per track
+    *   @param  number      Servo number, 0 ... 63
+    *   @return Returns the address of the sample
+    */
+    constexpr uint32_t showTrack(uint32_t frame, uint32_t maxFrames, uint8_t number) {
+        return frame + (maxFrames * number);
+    }
+
+    /**
+    *   @brief  Get the number of samples stored for a servo track
+    *
+    *   @param  frames      Frames in the show
+    *   @param  divisor     Frames per stored sample, 1 ... 255
+    *   @return Returns the length of the track in bytes
+    */
+    constexpr uint32_t showTrackLength(uint32_t frames, uint8_t divisor) {
+        return (frames + divisor - 1) / divisor;
+    }
+
+    /**
+    *   @brief  Get the number of bytes covered by a block CRC, the last block stops where the header starts
+    *
+    *   @param  block   Block number, 0 ... CRC_BLOCKS - 1
+    *   @return Returns the size of the block in bytes
+    */
+    constexpr uint16_t crcBlockSize(uint8_t block) {
+        return ((block + 1) * CRC_BLOCK_SIZE <= SHOW_HEADER) ? CRC_BLOCK_SIZE : SHOW_HEADER - (block * CRC_BLOCK_SIZE);
+    }
+
+    /**
+    *   @brief  Read a servo track at a frame, interpolating between stored samples
+    *
+    *   The last sample holds to the end of the show, there is nothing after it to ease towards
+    *
+    *   @param  track       First sample of the track
+    *   @param  length      Length of the track in bytes
+    *   @param  frame       Frame number, 0x0000 ... 0xFFE0
+    *   @param  divisor     Frames per stored sample, 1 ... 255
+    *   @return Returns the value at the frame, 0 ... 255
+    */
+    inline uint8_t readTrack(const uint8_t* track, uint32_t length, uint32_t frame, uint8_t divisor) {
+        uint32_t sample = frame / divisor;
+        uint8_t step = frame % divisor;
+
+        if (step == 0 || sample + 1 >= length) {
+            return track[sample];
+        }
+
+        int16_t from = track[sample];
+        return from + (((track[sample + 1] - from) * step) / divisor);
+    }
+
+    static_assert(CONF_LIPSYNC + 6 <= CONF_IDLE, "Lip sync settings overlap the idle settings");
+    static_assert(CONF_IDLE + 3 <= CONF_OUTPUTS, "Idle settings overlap the outputs");
+    static_assert(confOutput(8) <= CONF_TRIGGER, "Outputs overlap the trigger settings");
+    static_assert(CONF_TRIGGER + 5 <= CONF_BOARD_BUS, "Trigger settings overlap the board buses");
+    static_assert(CONF_BOARD_BUS + MAX_BOARDS <= CONF_CURVES, "Board buses overlap the input curves");
+    static_assert(CONF_CURVES + (16 * CONF_CURVE_SIZE) <= CONF_INPUTS, "Input curves overlap the inputs");
+    static_assert(confInput(16) <= CONF_SERVOS_LOW, "Inputs overlap the servos");
+    static_assert(confServo(15) + CONF_SERVO_SIZE <= CONF_FILTERS_LOW, "Servos overlap the filters");
+    static_assert(confFilter(15) < CONF_LATENCY, "Filters overlap the servo latencies");
+    static_assert(CONF_LATENCY + (64 * CONF_LATENCY_SIZE) <= CONF_SERVOS_HIGH, "Servo latencies overlap the servos");
+    static_assert(confServo(63) + CONF_SERVO_SIZE <= CONF_FILTERS_HIGH, "Servos overlap the filters");
+    static_assert(confFilter(63) < CONF_PROFILES, "Filters overlap the motion profiles");
+    static_assert(CONF_PROFILES + (64 * CONF_PROFILE_SIZE) <= CONF_SIZE, "Motion profiles do not fit the config file");
+    static_assert(SHOW_NAME + 16 == SHOW_SIZE, "Show header does not end the show data");
+    static_assert(CRC_BLOCKS * CRC_BLOCK_SIZE == SHOW_SIZE, "Block CRCs do not cover the show data");
+
+#endif  // LAYOUT_H_
@@ -1,3 +1,3 @@
 #!/usr/bin/env bash
 
-cpplint Animatronics_Controller.ino audio.h audio.cpp config.h config.cpp interface.h interface.cpp servo.h servo.cpp show.h show.cpp
+cpplint Animatronics_Controller.ino audio.h audio.cpp config.h config.cpp interface.h interface.cpp servo.h servo.cpp show.h show.cpp storage.h storage.cpp events.h events.cpp timing.h timing.cpp wavplayer.h wavplayer.cpp sdio.h sdio.cpp sync.h sync.cpp lipsync.h lipsync.cpp crc.h crc.cpp channels.h render.h render.cpp layout.h trigger.h trigger.cpp telemetry.h telemetry.cpp playlist.h playlist.cpp idle.h idle.cpp memory.h memory.cpp soak.h soak.cpp
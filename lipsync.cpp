@@ -0,0 +1,145 @@
+/**
+*   @file   lipsync.cpp
+*   @brief  Functions for driving a mouth servo from the envelope of the show audio
+*
+*   The envelope is the RMS of the audio after a ~140Hz high pass and a ~3kHz low pass,
+*   so breaths and rumble do not open the mouth, smoothed with separate attack and release.
+*   Everything is fixed point Q15 so it can run in the audio interrupt.
+*/
+
+#include "lipsync.h"
+#include "config.h"
+#include "show.h"
+#include <SD.h>
+
+#define HIGH_PASS_COEF 32113  // Q15, ~140Hz one pole at 44.1kHz
+#define LOW_PASS_COEF 11370  // Q15, ~3kHz one pole at 44.1kHz
+
+lipsync_t lipsyncSettings = {};
+int32_t attackCoef = 32768;
+int32_t releaseCoef = 32768;
+uint32_t leadSamples = 0;
+
+int32_t envelopeCoefficient(uint8_t ms) {
+    // Q15 share of the distance to the new level moved in one 128 sample block
+    uint32_t blockUS = ((uint32_t)AUDIO_BLOCK_SAMPLES * 1000000) / WAV_SAMPLE_RATE;
+    return (32768 * blockUS) / ((ms * 1000) + blockUS);
+}
+
+void setupLipsync() {
+    lipsyncSettings = getLipsyncData();
+
+    if (lipsyncSettings.gain == 0) {
+        lipsyncSettings.gain = 16;
+    }
+
+    attackCoef = envelopeCoefficient(lipsyncSettings.attack);
+    releaseCoef = envelopeCoefficient(lipsyncSettings.release);
+    leadSamples = ((uint32_t)lipsyncSettings.lead * WAV_SAMPLE_RATE) / 1000;
+}
+
+bool isLipsyncServo(uint8_t number) {
+    return lipsyncSettings.mode != LIPSYNC_OFF && lipsyncSettings.servo == number;
+}
+
+bool isLipsyncLive() {
+    return lipsyncSettings.mode == LIPSYNC_LIVE;
+}
+
+uint8_t followEnvelope(envelope_t* envelope, const int16_t* samples, uint16_t count) {
+    int64_t sum = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        envelope->highPass = samples[i] - envelope->previous + ((envelope->highPass * HIGH_PASS_COEF) >> 15);
+        envelope->previous = samples[i];
+        envelope->lowPass += ((envelope->highPass - envelope->lowPass) * LOW_PASS_COEF) >> 15;
+        sum += (int64_t)envelope->lowPass * envelope->lowPass;
+    }
+
+    int32_t rms = min((int32_t)isqrt(sum / max(count, (uint16_t)1)), (int32_t)32767);
+    int32_t coef = (rms > envelope->level) ? attackCoef : releaseCoef;
+    envelope->level += ((rms - envelope->level) * coef) >> 15;
+
+    return min((envelope->level * lipsyncSettings.gain) >> 11, (int32_t)255);
+}
+
+uint8_t AudioAnalyzeLipsync::read() {
+    return value;
+}
+
+void AudioAnalyzeLipsync::update() {
+    audio_block_t* block = receiveReadOnly(0);
+
+    if (lipsyncSettings.mode == LIPSYNC_LIVE) {
+        int16_t samples[AUDIO_BLOCK_SAMPLES];
+
+        if (source.peek(leadSamples, samples, AUDIO_BLOCK_SAMPLES)) {
+            value = followEnvelope(&envelope, samples, AUDIO_BLOCK_SAMPLES);
+        } else if (block) {
+            value = followEnvelope(&envelope, block->data, AUDIO_BLOCK_SAMPLES);
+        }
+    }
+
+    if (block) {
+        release(block);
+    }
+}
+
+void bakeLipsync() {
+    if (lipsyncSettings.mode != LIPSYNC_BAKE) {
+        return;
+    }
+
+    char audioFile[8] = "";
+    sprintf(audioFile, "%03d.WAV", getShowNumber());
+
+    File wavFile = SD.open(audioFile);
+    uint8_t channels = 0;
+    uint32_t dataSize = 0;
+
+    if (!wavFile || !openWavData(wavFile, &channels, &dataSize)) {
+        Serial.print("Error opening: ");
+        Serial.println(audioFile);
+        wavFile.close();
+        return;
+    }
+
+    Serial.println("Baking lip sync...");
+
+    envelope_t envelope = {};
+    int16_t raw[AUDIO_BLOCK_SAMPLES * 2];
+    int16_t mono[AUDIO_BLOCK_SAMPLES];
+    uint8_t value = 0;
+    uint64_t samples = 0;
+    uint32_t frame = 0;
+    uint32_t maxFrames = getShowMaxFrameCount();
+    uint32_t leadFrames = (lipsyncSettings.lead + (SAMPLE_RATE / 2)) / SAMPLE_RATE;
+
+    while (frame < maxFrames + leadFrames) {
+        int bytes = wavFile.read(raw, AUDIO_BLOCK_SAMPLES * channels * 2);
+
+        if (bytes <= 0) {
+            break;
+        }
+
+        uint16_t count = bytes / (channels * 2);
+
+        for (uint16_t i = 0; i < count; i++) {
+            mono[i] = (channels == 2) ? (raw[i * 2] + raw[(i * 2) + 1]) / 2 : raw[i];
+        }
+
+        value = followEnvelope(&envelope, mono, count);
+        samples += count;
+
+        // Write every frame that ended in this block, moved earlier by the servo lead
+        while (frame < maxFrames + leadFrames && ((uint64_t)(frame + 1) * SAMPLE_RATE * WAV_SAMPLE_RATE) / 1000 <= samples) {
+            if (frame >= leadFrames) {
+                recordTrack(frame - leadFrames, lipsyncSettings.servo, value);
+            }
+
+            frame++;
+        }
+    }
+
+    wavFile.close();
+}
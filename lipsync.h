@@ -0,0 +1,100 @@
+/**
+*   @file   lipsync.h
+*   @brief  Functions for driving a mouth servo from the envelope of the show audio
+*/
+
+#ifndef LIPSYNC_H_
+    #define LIPSYNC_H_
+
+    #include "wavplayer.h"
+    #include <Arduino.h>
+    #include <Audio.h>
+
+    #define LIPSYNC_OFF 0
+    #define LIPSYNC_LIVE 1  // Envelope follows the audio while the show plays
+    #define LIPSYNC_BAKE 2  // Envelope is written to the servo track by newShow()
+
+    /**
+    *   @brief  Struct for Lip Sync settings
+    */
+    struct lipsync_t {
+        uint8_t mode;
+        uint8_t servo;
+        uint8_t attack;  // ms
+        uint8_t release;  // ms
+        uint8_t lead;  // ms the mouth moves ahead of the sound, the servo's mechanical lag
+        uint8_t gain;  // 16 = 1x
+    };
+
+    /**
+    *   @brief  Struct for the envelope follower state
+    */
+    struct envelope_t {
+        int32_t highPass;
+        int32_t lowPass;
+        int32_t previous;
+        int32_t level;
+    };
+
+    /**
+    *   @brief  Runs the envelope follower on the audio ahead of the output
+    *
+    *   Connected to the WAV player like any analyzer, but reads its samples from the
+    *   player's ring buffer lead ms ahead of what is being played
+    */
+    class AudioAnalyzeLipsync : public AudioStream {
+        public:
+            AudioAnalyzeLipsync(AudioPlayShowWav &player) : AudioStream(1, inputQueueArray), source(player) {}
+
+            /**
+            *   @brief  Get the latest envelope value
+            *
+            *   @return Returns the envelope scaled for a servo track, 0 ... 255
+            */
+            uint8_t read(void);
+
+            virtual void update(void);
+
+        private:
+            audio_block_t* inputQueueArray[1];
+            AudioPlayShowWav &source;
+            envelope_t envelope = {};
+            volatile uint8_t value = 0;
+    };
+
+    /**
+    *   @brief  Load the lip sync settings from the config file
+    */
+    void setupLipsync(void);
+
+    /**
+    *   @brief  Check if a given servo is driven by the lip sync envelope
+    *
+    *   @param  number  Servo number, 0 ... 63
+    *   @return ```true``` if the servo is the lip sync servo and lip sync is on and ```false``` if not
+    */
+    bool isLipsyncServo(uint8_t number);
+
+    /**
+    *   @brief  Check if the lip sync envelope is followed live during playback
+    *
+    *   @return ```true``` if the mode is LIPSYNC_LIVE and ```false``` if not
+    */
+    bool isLipsyncLive(void);
+
+    /**
+    *   @brief  Run one block of samples through an envelope follower
+    *
+    *   @param  envelope    Envelope follower state
+    *   @param  samples     Mono samples
+    *   @param  count       Number of samples
+    *   @return Returns the envelope scaled for a servo track, 0 ... 255
+    */
+    uint8_t followEnvelope(envelope_t* envelope, const int16_t* samples, uint16_t count);
+
+    /**
+    *   @brief  Write the envelope of the loaded show's WAV file to the lip sync servo track
+    */
+    void bakeLipsync(void);
+
+#endif  // LIPSYNC_H_
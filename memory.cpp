@@ -0,0 +1,152 @@
+/**
+*   @file   memory.cpp
+*   @brief  Functions for placing the show data in memory and reporting the memory budget
+*
+*   Playback reads each track in order, one byte per servo per frame, so the data cache
+*   keeps the working window of a show in external RAM as close as the fast pool.
+*/
+
+#include "memory.h"
+#include "audio.h"
+#include "show.h"
+#include <Audio.h>
+
+#if defined(__IMXRT1062__)
+    extern "C" uint8_t external_psram_size;
+    extern unsigned long _ebss;
+    extern unsigned long _heap_end;
+    extern "C" char* __brkval;
+#endif
+
+uint8_t arenaFast[ARENA_FAST_SIZE];
+uint8_t* arena = NULL;
+uint32_t arenaSize = 0;
+uint8_t arenaTier = ARENA_FAST;
+
+uint8_t* allocArena(uint32_t size) {
+    freeArena();
+
+    if (size <= sizeof(arenaFast)) {
+        arena = arenaFast;
+        arenaTier = ARENA_FAST;
+    } else {
+#if defined(ARDUINO_TEENSY41)
+        if (external_psram_size > 0) {
+            arena = (uint8_t*)extmem_malloc(size);
+            arenaTier = ARENA_EXTERNAL;
+        }
+#endif
+
+        if (arena == NULL) {
+            arena = (uint8_t*)malloc(size);
+            arenaTier = ARENA_HEAP;
+        }
+    }
+
+    arenaSize = (arena != NULL) ? size : 0;
+
+    return arena;
+}
+
+uint8_t* resizeArena(uint32_t size) {
+    if (arena == NULL) {
+        return allocArena(size);
+    }
+
+    if (size <= arenaSize || (arenaTier == ARENA_FAST && size <= sizeof(arenaFast))) {
+        arenaSize = max(arenaSize, size);
+        return arena;
+    }
+
+    uint8_t* grown = NULL;
+    uint8_t tier = arenaTier;
+
+    if (arenaTier == ARENA_FAST) {
+#if defined(ARDUINO_TEENSY41)
+        if (external_psram_size > 0) {
+            grown = (uint8_t*)extmem_malloc(size);
+            tier = ARENA_EXTERNAL;
+        }
+#endif
+
+        if (grown == NULL) {
+            grown = (uint8_t*)malloc(size);
+            tier = ARENA_HEAP;
+        }
+
+        if (grown != NULL) {
+            memcpy(grown, arena, arenaSize);
+        }
+    } else if (arenaTier == ARENA_HEAP) {
+        grown = (uint8_t*)realloc(arena, size);
+    }
+
+#if defined(ARDUINO_TEENSY41)
+    if (arenaTier == ARENA_EXTERNAL) {
+        grown = (uint8_t*)extmem_realloc(arena, size);
+    }
+#endif
+
+    if (grown == NULL) {
+        return NULL;
+    }
+
+    arena = grown;
+    arenaSize = size;
+    arenaTier = tier;
+
+    return arena;
+}
+
+void freeArena() {
+    if (arena != NULL && arenaTier == ARENA_HEAP) {
+        free(arena);
+    }
+
+#if defined(ARDUINO_TEENSY41)
+    if (arena != NULL && arenaTier == ARENA_EXTERNAL) {
+        extmem_free(arena);
+    }
+#endif
+
+    arena = NULL;
+    arenaSize = 0;
+}
+
+uint32_t getFreeHeap() {
+#if defined(__IMXRT1062__)
+    return (uint32_t)((char*)&_heap_end - __brkval);
+#else
+    return 0;
+#endif
+}
+
+void printMemory() {
+    const char* tiers[] = {"fast RAM", "heap", "external RAM"};
+
+    Serial.println("\n---- Memory Report ----");
+    Serial.print("Show data: ");
+    Serial.print(arenaSize);
+    Serial.print(" bytes in ");
+    Serial.print(tiers[arenaTier]);
+    Serial.print(" | Tracks use: ");
+    Serial.println(getTrackBytes());
+    Serial.print("Audio blocks: ");
+    Serial.print(AUDIO_BLOCKS);
+    Serial.print(" (");
+    Serial.print(AUDIO_BLOCKS * sizeof(audio_block_t));
+    Serial.print(" bytes) | Max used: ");
+    Serial.println(AudioMemoryUsageMax());
+
+#if defined(__IMXRT1062__)
+    char stackTop;
+
+    // The stack grows down towards the statics, the heap grows up towards its end
+    Serial.print("Free fast RAM: ");
+    Serial.println((uint32_t)(&stackTop - (char*)&_ebss));
+    Serial.print("Free heap: ");
+    Serial.println(getFreeHeap());
+    Serial.print("External RAM MB: ");
+    Serial.println(external_psram_size);
+#endif
+}
@@ -0,0 +1,54 @@
+/**
+*   @file   memory.h
+*   @brief  Functions for placing the show data in memory and reporting the memory budget
+*/
+
+#ifndef MEMORY_H_
+    #define MEMORY_H_
+
+    #include <Arduino.h>
+
+    #define ARENA_FAST_SIZE 0x2000  // Shows up to 8 KB stay in tightly coupled RAM
+
+    #define ARENA_FAST 0  // Static pool in tightly coupled RAM
+    #define ARENA_HEAP 1  // Heap in on chip RAM
+    #define ARENA_EXTERNAL 2  // PSRAM chip, Teensy 4.1 only
+
+    /**
+    *   @brief  Allocate the show arena, the previous arena is freed first
+    *
+    *   Small shows use the fast pool, larger ones go to external RAM when it is fitted and the heap when not
+    *
+    *   @param  size    Number of bytes needed
+    *   @return Returns the arena, NULL if there is not enough memory
+    */
+    uint8_t* allocArena(uint32_t size);
+
+    /**
+    *   @brief  Grow the show arena, keeping its contents
+    *
+    *   A full fast pool moves up to external RAM or the heap, the heap and external RAM grow in place when they can
+    *
+    *   @param  size    Number of bytes needed
+    *   @return Returns the arena, NULL if there is not enough memory, the old arena is then left as it was
+    */
+    uint8_t* resizeArena(uint32_t size);
+
+    /**
+    *   @brief  Free the show arena
+    */
+    void freeArena(void);
+
+    /**
+    *   @brief  Get the free space between the top of the heap and its end
+    *
+    *   @return Returns the number of free heap bytes, 0 if it cannot be measured on this board
+    */
+    uint32_t getFreeHeap(void);
+
+    /**
+    *   @brief  Prints the show arena, audio blocks and free memory
+    */
+    void printMemory(void);
+
+#endif  // MEMORY_H_
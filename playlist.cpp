@@ -0,0 +1,203 @@
+/**
+*   @file   playlist.cpp
+*   @brief  Functions for playing shows from a playlist file instead of in number order
+*
+*   PLAYLIST.TXT has one entry per line: show [repeat [gap ms [weight [from hour [to hour]]]]].
+*   Missing fields default to 1 play, no gap, weight 1 and all day. A line reading "random"
+*   picks entries by weight instead of in order, and "#" starts a comment.
+*
+*   3 2 500        Show 3, twice, 500ms after the previous show
+*   7 1 0 4 9 17   Show 7, 4 times as likely as a weight 1 entry, 09:00 to 17:00 only
+*/
+
+#include "playlist.h"
+#include "idle.h"
+#include "show.h"
+#include <SD.h>
+
+#define PLAYLIST_LINE_SIZE 64
+
+char playlistFile[13] = "PLAYLIST.TXT";
+entry_t playlist[MAX_PLAYLIST_ENTRIES];
+uint8_t playlistCount = 0;
+uint8_t playlistNext = 0;
+bool playlistRandom = false;
+uint32_t playlistEndMS = 0;
+
+void parseEntry(char* line) {
+    char* end;
+    long values[6] = {-1, 1, 0, 1, 0, 24};
+
+    if (strncmp(line, "random", 6) == 0) {
+        playlistRandom = true;
+        return;
+    }
+
+    for (uint8_t v = 0; v < 6; v++) {
+        long value = strtol(line, &end, 10);
+
+        if (end == line) {
+            break;
+        }
+
+        values[v] = value;
+        line = end;
+    }
+
+    if (values[0] < 0 || values[0] > 255 || playlistCount >= MAX_PLAYLIST_ENTRIES) {
+        return;
+    }
+
+    entry_t &e = playlist[playlistCount++];
+    e.show = values[0];
+    e.repeat = constrain(values[1], 1, 255);
+    e.gapMS = max(values[2], 0L);
+    e.weight = constrain(values[3], 0, 65535);
+    e.hourFrom = constrain(values[4], 0, 24);
+    e.hourTo = constrain(values[5], 0, 24);
+}
+
+void loadPlaylist() {
+    char line[PLAYLIST_LINE_SIZE];
+    uint8_t fill = 0;
+
+    playlistCount = 0;
+    playlistNext = 0;
+    playlistRandom = false;
+
+    File file = SD.open(playlistFile);
+
+    if (!file) {
+        return;
+    }
+
+    while (file.available() > 0) {
+        char c = file.read();
+
+        if (c == '\n' || c == '\r') {
+            line[fill] = 0x00;
+            fill = 0;
+
+            if (line[0] != '#') {
+                parseEntry(line);
+            }
+        } else if (fill < PLAYLIST_LINE_SIZE - 1) {
+            line[fill++] = c;
+        }
+    }
+
+    line[fill] = 0x00;
+
+    if (line[0] != '#') {
+        parseEntry(line);
+    }
+
+    file.close();
+    randomSeed(micros() ^ Teensy3Clock.get());
+}
+
+bool hasPlaylist() {
+    return playlistCount > 0;
+}
+
+bool isEntryPlayable(const entry_t &e) {
+    uint8_t hour = (Teensy3Clock.get() / 3600) % 24;
+    bool inHours = (e.hourFrom <= e.hourTo) ? (hour >= e.hourFrom && hour < e.hourTo) : (hour >= e.hourFrom || hour < e.hourTo);
+
+    return inHours && showExists(e.show);
+}
+
+int16_t pickEntry() {
+    if (playlistRandom) {
+        uint32_t total = 0;
+
+        for (uint8_t i = 0; i < playlistCount; i++) {
+            total += isEntryPlayable(playlist[i]) ? playlist[i].weight : 0;
+        }
+
+        if (total == 0) {
+            return -1;
+        }
+
+        uint32_t pick = random(total);
+
+        for (uint8_t i = 0; i < playlistCount; i++) {
+            uint32_t weight = isEntryPlayable(playlist[i]) ? playlist[i].weight : 0;
+
+            if (pick < weight) {
+                return i;
+            }
+
+            pick -= weight;
+        }
+
+        return -1;
+    }
+
+    // In order, skipping entries that are out of hours or missing
+    for (uint8_t tries = 0; tries < playlistCount; tries++) {
+        uint8_t i = playlistNext;
+        playlistNext = (playlistNext + 1) % playlistCount;
+
+        if (isEntryPlayable(playlist[i])) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void playPlaylist() {
+    int16_t i = pickEntry();
+
+    if (i < 0) {
+        delay(10);
+        return;
+    }
+
+    const entry_t &e = playlist[i];
+
+    // The show is read during the gap, so only a gap shorter than the load adds time
+    if (!loadShow(e.show)) {
+        return;
+    }
+
+    for (uint8_t r = 0; r < e.repeat; r++) {
+        while (millis() - playlistEndMS < e.gapMS) {
+            serviceIdle();
+        }
+
+        playShow();
+        playlistEndMS = millis();
+        startIdle();
+
+        if (isShowStopped()) {
+            return;
+        }
+    }
+}
+
+void printPlaylist() {
+    if (!hasPlaylist()) {
+        return;
+    }
+
+    Serial.print("\n---- Playlist ");
+    Serial.print(playlistRandom ? "Random" : "In Order");
+    Serial.println(" ----");
+
+    for (uint8_t i = 0; i < playlistCount; i++) {
+        Serial.print("Show ");
+        Serial.print(playlist[i].show);
+        Serial.print(" | x");
+        Serial.print(playlist[i].repeat);
+        Serial.print(" | Gap ms: ");
+        Serial.print(playlist[i].gapMS);
+        Serial.print(" | Weight: ");
+        Serial.print(playlist[i].weight);
+        Serial.print(" | Hours: ");
+        Serial.print(playlist[i].hourFrom);
+        Serial.print("-");
+        Serial.println(playlist[i].hourTo);
+    }
+}
@@ -0,0 +1,47 @@
+/**
+*   @file   playlist.h
+*   @brief  Functions for playing shows from a playlist file instead of in number order
+*/
+
+#ifndef PLAYLIST_H_
+    #define PLAYLIST_H_
+
+    #include <Arduino.h>
+
+    #define MAX_PLAYLIST_ENTRIES 64
+
+    /**
+    *   @brief  Struct for one playlist entry
+    */
+    struct entry_t {
+        uint8_t show;
+        uint8_t repeat;  // Times to play the show each time the entry comes up
+        uint16_t weight;  // Chance of the entry in random mode, relative to the other entries
+        uint32_t gapMS;  // Wait after the previous show before this one starts
+        uint8_t hourFrom;  // Only played from this hour ...
+        uint8_t hourTo;  // ... up to, not including, this hour, 0 ... 24
+    };
+
+    /**
+    *   @brief  Read PLAYLIST.TXT from the SD card into the playlist, called once at boot
+    */
+    void loadPlaylist(void);
+
+    /**
+    *   @brief  Check if a playlist was loaded
+    *
+    *   @return ```true``` if there is a playlist and ```false``` if shows play in number order
+    */
+    bool hasPlaylist(void);
+
+    /**
+    *   @brief  Pick the next playlist entry and play it, the show is loaded during the gap before it
+    */
+    void playPlaylist(void);
+
+    /**
+    *   @brief  Prints the playlist
+    */
+    void printPlaylist(void);
+
+#endif  // PLAYLIST_H_
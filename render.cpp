@@ -0,0 +1,236 @@
+/**
+*   @file   render.cpp
+*   @brief  Functions for caching the final servo positions of a show on the SD card
+*
+*   "%03d.PWM" holds a 16 byte header ("PWM1", key, servo count, frame count) followed
+*   by one uint16 position per servo per frame, frame after frame, so playback only
+*   streams ticks to the boards and a seek is a single file seek.
+*/
+
+#include "render.h"
+#include "config.h"
+#include "crc.h"
+#include "layout.h"
+#include "lipsync.h"
+#include "sdio.h"
+#include "servo.h"
+#include "show.h"
+#include "storage.h"
+#include <SD.h>
+
+#define RENDER_HEADER_SIZE 16
+#define RENDER_BUFFER_SIZE 4096  // Power of 2
+#define RENDER_BUFFER_MASK (RENDER_BUFFER_SIZE - 1)
+
+char renderName[8] = "";
+File RENDER_FILE;
+uint8_t renderBuffer[RENDER_BUFFER_SIZE];
+uint32_t renderReadPos = 0;
+uint32_t renderWritePos = 0;
+uint32_t renderFrame = 0;
+uint16_t renderFrameBytes = 0;
+uint8_t renderServoCount = 0;
+bool renderOpen = false;
+uint32_t renderFrames = 0;
+uint32_t renderMisses = 0;
+
+uint32_t getRenderKey() {
+    uint32_t key = getShowKey();
+    uint8_t servoCount = getServoCount();
+
+    for (uint8_t s = 0; s < servoCount; s++) {
+        servo_t d = getServoData(s);
+        uint8_t data[9] = {d.enabled, d.pin, (uint8_t)(d.min & 0xFF), (uint8_t)(d.min >> 8),
+            (uint8_t)(d.max & 0xFF), (uint8_t)(d.max >> 8), d.filter, d.invert, d.lead};
+
+        key = crc32(key, data, sizeof(data));
+    }
+
+    return key;
+}
+
+void renderHeader(uint8_t* header, uint32_t key, uint8_t servoCount, uint32_t frames) {
+    memset(header, 0, RENDER_HEADER_SIZE);
+    memcpy(header, "PWM1", 4);
+
+    for (uint8_t b = 0; b < 4; b++) {
+        header[4 + b] = (key >> (b * 8)) & 0xFF;
+        header[12 + b] = (frames >> (b * 8)) & 0xFF;
+    }
+
+    header[8] = servoCount;
+}
+
+bool renderShow() {
+    if (isLipsyncLive()) {
+        Serial.println("Shows with live lip sync can not be rendered");
+        return false;
+    }
+
+    uint8_t servoCount = getServoCount();
+    uint32_t frames = getShowMaxFrameCount();
+    uint8_t header[RENDER_HEADER_SIZE];
+    uint8_t data[MAX_SERVOS * 2];
+
+    // A track that is corrupt from the first frame holds the servo at center, not at 0 ticks
+    for (uint8_t s = 0; s < servoCount; s++) {
+        data[s * 2] = getServoCenter(s) & 0xFF;
+        data[(s * 2) + 1] = getServoCenter(s) >> 8;
+    }
+
+    sprintf(renderName, "%03d.PWM", getShowNumber());
+    renderHeader(header, getRenderKey(), servoCount, frames);
+
+    if (!beginSave(renderName) || !writeSave(header, sizeof(header))) {
+        abortSave();
+        return false;
+    }
+
+    // Same starting filter state as playShowAt(0)
+    seekShow(0);
+
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint8_t s = 0; s < servoCount; s++) {
+            // A corrupt track keeps the ticks of the frame before
+            if (isTrackCorrupt(getLeadFrame(f, s), s)) {
+                continue;
+            }
+
+            uint16_t ticks = computeServo(s, getTrackValue(getLeadFrame(f, s), s));
+            data[s * 2] = ticks & 0xFF;
+            data[(s * 2) + 1] = ticks >> 8;
+        }
+
+        if (!writeSave(data, servoCount * 2)) {
+            abortSave();
+            return false;
+        }
+    }
+
+    if (!commitSave()) {
+        return false;
+    }
+
+    Serial.print("Rendered: ");
+    Serial.println(renderName);
+
+    return true;
+}
+
+bool openRender(uint32_t frame) {
+    uint8_t header[RENDER_HEADER_SIZE];
+    uint8_t expected[RENDER_HEADER_SIZE];
+
+    closeRender();
+
+    if (isLipsyncLive()) {
+        return false;
+    }
+
+    sprintf(renderName, "%03d.PWM", getShowNumber());
+
+    if (!SD.exists(renderName)) {
+        return false;
+    }
+
+    RENDER_FILE = SD.open(renderName);
+
+    if (!RENDER_FILE) {
+        return false;
+    }
+
+    renderServoCount = getServoCount();
+    renderHeader(expected, getRenderKey(), renderServoCount, getShowMaxFrameCount());
+
+    if (RENDER_FILE.read(header, sizeof(header)) != sizeof(header) || memcmp(header, expected, sizeof(header)) != 0) {
+        RENDER_FILE.close();
+        return false;
+    }
+
+    renderFrameBytes = renderServoCount * 2;
+    RENDER_FILE.seek(RENDER_HEADER_SIZE + (frame * renderFrameBytes));
+    renderReadPos = 0;
+    renderWritePos = 0;
+    renderFrame = frame;
+    renderFrames = 0;
+    renderMisses = 0;
+    renderOpen = true;
+
+    while (renderWritePos - renderReadPos < RENDER_BUFFER_SIZE - SECTOR_SIZE && RENDER_FILE.available()) {
+        serviceRender();
+    }
+
+    return true;
+}
+
+void serviceRender() {
+    uint32_t space = RENDER_BUFFER_SIZE - (renderWritePos - renderReadPos);
+
+    // Once the file is read to its end every pass would make a read call that returns nothing
+    if (!renderOpen || space < SECTOR_SIZE || !RENDER_FILE.available()) {
+        return;
+    }
+
+    // One sector per call, never across the end of the buffer
+    uint32_t contiguous = RENDER_BUFFER_SIZE - (renderWritePos & RENDER_BUFFER_MASK);
+    renderWritePos += readBlocks(RENDER_FILE, &renderBuffer[renderWritePos & RENDER_BUFFER_MASK], min(contiguous, (uint32_t)SECTOR_SIZE));
+}
+
+bool playRender(uint32_t frame) {
+    if (!renderOpen) {
+        return false;
+    }
+
+    // Drop frames that were computed live while the buffer was behind
+    while (renderFrame < frame && (renderWritePos - renderReadPos) >= renderFrameBytes) {
+        renderReadPos += renderFrameBytes;
+        renderFrame++;
+    }
+
+    if (renderFrame != frame || (renderWritePos - renderReadPos) < renderFrameBytes) {
+        renderMisses++;
+        return false;
+    }
+
+    for (uint8_t s = 0; s < renderServoCount; s++) {
+        uint16_t ticks = renderBuffer[renderReadPos & RENDER_BUFFER_MASK] + (renderBuffer[(renderReadPos + 1) & RENDER_BUFFER_MASK] << 8);
+        playServoTicks(s, ticks);
+        renderReadPos += 2;
+    }
+
+    renderFrame++;
+    renderFrames++;
+
+    return true;
+}
+
+void closeRender() {
+    if (renderOpen) {
+        RENDER_FILE.close();
+        renderOpen = false;
+    }
+}
+
+void clearRenders() {
+    char name[8] = "";
+
+    for (uint16_t n = 0; n < 256; n++) {
+        sprintf(name, "%03d.PWM", n);
+
+        if (SD.exists(name)) {
+            SD.remove(name);
+        }
+    }
+}
+
+void printRender() {
+    if (renderFrames == 0 && renderMisses == 0) {
+        return;
+    }
+
+    Serial.println("\n---- Render Report ----");
+    Serial.print("Rendered frames: ");
+    Serial.print(renderFrames);
+    Serial.print(" | Computed live: ");
+    Serial.println(renderMisses);
+}
@@ -0,0 +1,61 @@
+/**
+*   @file   render.h
+*   @brief  Functions for caching the final servo positions of a show on the SD card
+*/
+
+#ifndef RENDER_H_
+    #define RENDER_H_
+
+    #include <Arduino.h>
+
+    /**
+    *   @brief  Get the key of the loaded show under the current servo config
+    *
+    *   @return Returns the CRC-32 of the show data and the servo settings that change the output
+    */
+    uint32_t getRenderKey(void);
+
+    /**
+    *   @brief  Compute the final servo positions of every frame of the loaded show and save them
+    *
+    *   @return ```true``` if the render was saved and ```false``` if there was an error
+    */
+    bool renderShow(void);
+
+    /**
+    *   @brief  Open the render of the loaded show if it matches the show and config
+    *
+    *   @param  frame   Frame to start playing from, 0x0000 ... 0xFFE0
+    *   @return ```true``` if a matching render was opened and ```false``` if not
+    */
+    bool openRender(uint32_t frame);
+
+    /**
+    *   @brief  Read the open render into its buffer, call from the frame loop while waiting for the next frame
+    */
+    void serviceRender(void);
+
+    /**
+    *   @brief  Send a frame of servo positions from the open render
+    *
+    *   @param  frame   Frame to play, 0x0000 ... 0xFFE0
+    *   @return ```true``` if the frame was sent and ```false``` if it was not buffered in time
+    */
+    bool playRender(uint32_t frame);
+
+    /**
+    *   @brief  Close the open render
+    */
+    void closeRender(void);
+
+    /**
+    *   @brief  Delete every render on the SD card, called when the servo config changes
+    */
+    void clearRenders(void);
+
+    /**
+    *   @brief  Prints the render counters for the last show
+    */
+    void printRender(void);
+
+#endif  // RENDER_H_
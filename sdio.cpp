@@ -0,0 +1,120 @@
+/**
+*   @file   sdio.cpp
+*   @brief  Functions for sharing the SD card between WAV streaming and show data
+*
+*   Audio refill always goes first. Show data is moved one sector at a time and the
+*   audio ring is topped up before every sector, so a show read or write can never
+*   hold the card for longer than one sector while audio is waiting.
+*/
+
+#include "sdio.h"
+#include "audio.h"
+#include "crc.h"
+#include "idle.h"
+#include "storage.h"
+#include <Audio.h>
+
+#define AUDIO_REFILL_SECTORS 4  // Max sectors per serviceIO() call, ~1ms of card time
+#define AUDIO_LOW_WATER_MS 40  // Refill before a show sector when less than this is buffered
+
+uint32_t showSectors = 0;
+uint32_t showSectorMax = 0;
+uint32_t audioRefills = 0;
+uint32_t audioBufferedMin = 0xFFFFFFFF;
+
+void serviceIO() {
+    if (isAudioPlaying()) {
+        audioBufferedMin = min(audioBufferedMin, getAudioBufferedMS());
+        audioRefills += refillAudio(AUDIO_REFILL_SECTORS);
+    }
+}
+
+void refillBeforeSector() {
+    if (isAudioPlaying() && getAudioBufferedMS() < AUDIO_LOW_WATER_MS) {
+        serviceIO();
+    }
+}
+
+uint32_t readBlocks(File &file, uint8_t* data, uint32_t size) {
+    return readBlocksChecked(file, data, size, NULL);
+}
+
+uint32_t readBlocksChecked(File &file, uint8_t* data, uint32_t size, uint32_t* crcs) {
+    uint32_t total = 0;
+
+    while (total < size) {
+        refillBeforeSector();
+        serviceIdle();
+
+        uint32_t sectorStart = micros();
+        uint32_t want = min(size - total, (uint32_t)SECTOR_SIZE);
+        int count = file.read(data + total, want);
+        showSectorMax = max(showSectorMax, micros() - sectorStart);
+        showSectors++;
+
+        if (count <= 0) {
+            break;
+        }
+
+        // A short read is the end of the file or a card error, the rest of the sector is not there to check
+        if ((uint32_t)count < want) {
+            total += count;
+            break;
+        }
+
+        if (crcs != NULL) {
+            crcs[total / SECTOR_SIZE] = crc32(0, data + total, count);
+        }
+
+        total += count;
+    }
+
+    return total;
+}
+
+uint32_t writeBlocks(File &file, const uint8_t* data, uint32_t size) {
+    uint32_t total = 0;
+
+    while (total < size) {
+        refillBeforeSector();
+
+        uint32_t sectorStart = micros();
+        uint32_t count = file.write(data + total, min(size - total, (uint32_t)SECTOR_SIZE));
+        showSectorMax = max(showSectorMax, micros() - sectorStart);
+        showSectors++;
+
+        if (count == 0) {
+            break;
+        }
+
+        total += count;
+    }
+
+    return total;
+}
+
+void resetIO() {
+    showSectors = 0;
+    showSectorMax = 0;
+    audioRefills = 0;
+    audioBufferedMin = 0xFFFFFFFF;
+    AudioMemoryUsageMaxReset();
+}
+
+void printIO() {
+    Serial.println("\n---- SD / Audio Report ----");
+    Serial.print("Audio underruns: ");
+    Serial.println(getAudioUnderruns());
+    Serial.print("Audio memory max: ");
+    Serial.print(AudioMemoryUsageMax());
+    Serial.print(" / ");
+    Serial.println(AUDIO_BLOCKS);
+    Serial.print("Audio sectors refilled: ");
+    Serial.print(audioRefills);
+    Serial.print(" | Min buffered ms: ");
+    Serial.println(audioRefills > 0 ? audioBufferedMin : 0);
+    Serial.print("Show sectors: ");
+    Serial.print(showSectors);
+    Serial.print(" | Max sector us: ");
+    Serial.println(showSectorMax);
+}
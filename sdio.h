@@ -0,0 +1,58 @@
+/**
+*   @file   sdio.h
+*   @brief  Functions for sharing the SD card between WAV streaming and show data
+*/
+
+#ifndef SDIO_H_
+    #define SDIO_H_
+
+    #include <Arduino.h>
+    #include <SD.h>
+
+    /**
+    *   @brief  Give the SD card to the highest priority work, call from every loop that waits on a frame
+    */
+    void serviceIO(void);
+
+    /**
+    *   @brief  Read show data one sector at a time, refilling the audio ring between sectors
+    *
+    *   @param  file    File to read from
+    *   @param  data    Buffer to read into
+    *   @param  size    Number of bytes to read
+    *   @return Returns the number of bytes read
+    */
+    uint32_t readBlocks(File &file, uint8_t* data, uint32_t size);
+
+    /**
+    *   @brief  Read show data one sector at a time and take the CRC-32 of each sector while it is still in cache
+    *
+    *   @param  file    File to read from, positioned on a sector boundary
+    *   @param  data    Buffer to read into
+    *   @param  size    Number of bytes to read
+    *   @param  crcs    Returns the CRC-32 of each whole sector read, reading stops at the first short sector
+    *   @return Returns the number of bytes read
+    */
+    uint32_t readBlocksChecked(File &file, uint8_t* data, uint32_t size, uint32_t* crcs);
+
+    /**
+    *   @brief  Write show data one sector at a time, refilling the audio ring between sectors
+    *
+    *   @param  file    File to write to
+    *   @param  data    Data to write
+    *   @param  size    Number of bytes to write
+    *   @return Returns the number of bytes written
+    */
+    uint32_t writeBlocks(File &file, const uint8_t* data, uint32_t size);
+
+    /**
+    *   @brief  Reset the SD and audio counters, called at the start of each show
+    */
+    void resetIO(void);
+
+    /**
+    *   @brief  Prints the SD and audio counters for the last show
+    */
+    void printIO(void);
+
+#endif  // SDIO_H_
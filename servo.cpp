@@ -5,34 +5,237 @@
 
 #include "servo.h"
 #include "config.h"
+#include "audio.h"
+#include "channels.h"
 #include "interface.h"
+#include "layout.h"
+#include "lipsync.h"
 #include "show.h"
-#include <PWM_Servo.h>
-
-PWMServo servoBoard = PWMServo();  // Use default address 0x40
+#include "timing.h"
+#include <i2c_driver.h>
+#include <imx_rt1060/imx_rt1060_i2c_driver.h>
+
+#define PCA9685_MODE1 0x00
+#define PCA9685_PRESCALE 0xFE
+#define PCA9685_LED0_ON_L 0x06
+#define PCA9685_MODE1_SLEEP 0x10
+#define PCA9685_MODE1_AUTO_INCREMENT 0x20
+#define PCA9685_MODE1_RESTART 0x80
+#define PCA9685_OSC_HZ 25000000
+#define SERVO_PWM_HZ 60
+#define I2C_CLOCK_HZ 400000
+#define I2C_BURST_CHANNELS 16  // The interrupt sends from the queue, so a burst is not held to the 32 byte Wire buffer
+
+I2CMaster* const i2cBus[I2C_BUSES] = {&Master, &Master1, &Master2};
+uint8_t boardAddress[MAX_BOARDS];
+uint8_t boardBus[MAX_BOARDS];
+uint8_t boardCount = 1;
 
 input_t input[16];
-servo_t servo[16];
-float servoFilterValue[16];
+uint8_t inputTable[16][INPUT_TABLE_SIZE];
+servo_t servo[MAX_SERVOS];
+float servoFilterValue[MAX_SERVOS];
+uint8_t servoInputValue[MAX_SERVOS];
+uint16_t servoTicks[MAX_SERVOS];
+uint16_t servoDirty[MAX_BOARDS];
 
-void setupServos() {
-    servoBoard.begin();
-    servoBoard.setPWMFreq(60);
+/**
+*   @brief  Struct for the motion profile state of a servo, all values in 1/256 ticks
+*/
+struct motion_t {
+    int32_t position;
+    int32_t velocity;  // Per frame
+    int32_t accel;  // Per frame per frame
+};
+
+profile_t profile[MAX_SERVOS];
+motion_t motion[MAX_SERVOS];
+uint8_t motionSaturated = 0;
+uint16_t blendFrom[MAX_SERVOS];
+uint8_t blendFrames = 0;
+uint8_t blendLeft = 0;
+
+/**
+*   @brief  Struct for one I2C write of consecutive channels on a board
+*/
+struct burst_t {
+    uint8_t board;
+    uint16_t offset;  // First byte in burstBytes, the register number
+    uint8_t size;
+};
+
+// Each port has its own queue, so boards on different ports are sent at the same time
+burst_t burstQueue[I2C_BUSES][MAX_SERVOS];
+uint8_t burstBytes[MAX_SERVOS * 5];  // A register byte per burst and 4 bytes per channel, read by the interrupt while it sends
+uint8_t burstCount[I2C_BUSES] = {};
+uint8_t burstNext[I2C_BUSES] = {};
+
+/**
+*   @brief  Write a register of a board and wait for the write to finish, for setup only
+*
+*   @param  board   Board number, 0 ... boardCount - 1
+*   @param  reg     Register number
+*   @param  value   Value to write
+*/
+void writeBoard(uint8_t board, uint8_t reg, uint8_t value) {
+    uint8_t data[2] = {reg, value};
+    I2CMaster* bus = i2cBus[boardBus[board]];
+
+    bus->write_async(boardAddress[board], data, sizeof(data), true);
+
+    while (!bus->finished()) {
+        // The buffer is on the stack, it must outlive the transfer
+    }
+}
+
+void setupBoards() {
+    uint8_t prescale = (uint8_t)((PCA9685_OSC_HZ / (4096.0f * SERVO_PWM_HZ)) - 0.5f);
+
+    bool busUsed[I2C_BUSES] = {};
+
+    boardCount = getBoardCount();
+
+    for (uint8_t b = 0; b < boardCount; b++) {
+        boardAddress[b] = getBoardAddress(b);
+        boardBus[b] = getBoardBus(b);
+        servoDirty[b] = 0;
+
+        if (!busUsed[boardBus[b]]) {
+            busUsed[boardBus[b]] = true;
+            i2cBus[boardBus[b]]->begin(I2C_CLOCK_HZ);
+        }
 
+        // The prescaler only takes a new value while the oscillator sleeps
+        writeBoard(b, PCA9685_MODE1, PCA9685_MODE1_SLEEP);
+        writeBoard(b, PCA9685_PRESCALE, prescale);
+        writeBoard(b, PCA9685_MODE1, PCA9685_MODE1_AUTO_INCREMENT);
+        delayMicroseconds(500);  // Oscillator start up
+        writeBoard(b, PCA9685_MODE1, PCA9685_MODE1_RESTART | PCA9685_MODE1_AUTO_INCREMENT);
+    }
+}
+
+void setupServos() {
     loadConfig();
+    setupBoards();
 
     processInputs();
     processServos();
 
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
+        motion[s] = {(int32_t)getServoCenter(s) << 8, 0, 0};
+    }
+
     centerServos();
 }
 
+void reloadServos() {
+    bool boardsChanged = (getBoardCount() != boardCount);
+
+    for (uint8_t b = 0; b < boardCount && !boardsChanged; b++) {
+        boardsChanged = (getBoardAddress(b) != boardAddress[b]) || (getBoardBus(b) != boardBus[b]);
+    }
+
+    if (boardsChanged) {
+        flushServos();
+        setupBoards();
+    }
+
+    processInputs();
+
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
+        bool wasEnabled = servo[s].enabled;
+        servo[s] = getServoData(s);
+        profile[s] = getProfileData(s);
+
+        // A servo that was just enabled starts its filter at the middle of the show range instead of 0
+        if (servo[s].enabled && !wasEnabled) {
+            servoFilterValue[s] = SHOW_CENTER_VALUE;
+            motion[s] = {(int32_t)getServoCenter(s) << 8, 0, 0};
+        }
+    }
+
+    // More servos can mean more tracks than the show data in memory holds
+    if (!growShow()) {
+        Serial.println("Not enough memory for every servo track, the rest hold their pose");
+    }
+}
+
+/**
+*   @brief  Build the calibration table of a given input from its min, max and curve points
+*
+*   @param  number  Input number, 0 ... 15
+*/
+void buildInputTable(uint8_t number) {
+    const input_t &in = input[number];
+    curve_t curve = getCurveData(number);
+    uint16_t reading[CURVE_POINTS + 2] = {in.min};
+    uint8_t value[CURVE_POINTS + 2] = {0};
+    uint8_t count = 1;
+
+    // Points in reading order, points outside min / max or on top of another are ignored
+    for (uint8_t p = 0; p < CURVE_POINTS; p++) {
+        uint16_t r = curve.reading[p];
+
+        if (r == 0 || r <= in.min || r >= in.max) {
+            continue;
+        }
+
+        uint8_t at = count;
+
+        while (at > 1 && reading[at - 1] > r) {
+            reading[at] = reading[at - 1];
+            value[at] = value[at - 1];
+            at--;
+        }
+
+        if (reading[at - 1] == r) {
+            for (uint8_t m = at; m < count; m++) {
+                reading[m] = reading[m + 1];
+                value[m] = value[m + 1];
+            }
+
+            continue;
+        }
+
+        reading[at] = r;
+        value[at] = curve.value[p];
+        count++;
+    }
+
+    reading[count] = in.max;
+    value[count] = 255;
+    count++;
+
+    uint8_t segment = 0;
+
+    for (uint16_t r = 0; r < INPUT_TABLE_SIZE; r++) {
+        while (segment < count - 2 && r >= reading[segment + 1]) {
+            segment++;
+        }
+
+        if (r <= reading[0]) {
+            inputTable[number][r] = value[0];
+        } else if (r >= reading[count - 1]) {
+            inputTable[number][r] = value[count - 1];
+        } else {
+            int32_t from = value[segment];
+            int32_t span = reading[segment + 1] - reading[segment];
+            inputTable[number][r] = from + (((value[segment + 1] - from) * (int32_t)(r - reading[segment])) / span);
+        }
+    }
+}
+
 void processInputs() {
     for (uint8_t i = 0; i < 16; i++) {
         input[i] = getInputData(i);
+        buildInputTable(i);
     }
 }
 
+uint8_t readInput(uint8_t number) {
+    return inputTable[number][min(analogRead(input[number].pin), INPUT_TABLE_SIZE - 1)];
+}
+
 uint8_t getInputCount() {
     uint8_t count = 0;
 
@@ -46,15 +249,16 @@ uint8_t getInputCount() {
 }
 
 void processServos() {
-    for (uint8_t s = 0; s < 16; s++) {
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
         servo[s] = getServoData(s);
+        profile[s] = getProfileData(s);
     }
 }
 
 uint8_t getServoCount() {
     uint8_t count = 0;
 
-    for (uint8_t s = 0; s < 16; s++) {
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
         if (servo[s].enabled != 0) {
             count++;
         }
@@ -68,28 +272,127 @@ void centerServos() {
 
     for (uint8_t s = 0; s < servoCount; s++) {
 		if (servo[s].enabled) {
-			servoFilterValue[s] = getServoCenter(s);
-            servoBoard.setPin(s, getServoCenter(s));
+			servoFilterValue[s] = SHOW_CENTER_VALUE;
+            motion[s] = {(int32_t)getServoCenter(s) << 8, 0, 0};
+            setServo(s, getServoCenter(s));
         }
     }
+
+    flushServos();
 }
 
-void updateServo(uint8_t number) {
-    servo_t s = servo[number];
+void setServo(uint8_t pin, uint16_t ticks) {
+    // A pin past the last board has no dirty bit to send it and would write past the staged ticks
+    if (pin >= boardCount * 16) {
+        return;
+    }
 
-    if (s.enabled) {
-        s.input.value = analogRead(s.input.pin);
-        s.input.value = constrain(s.input.value, s.input.min, s.input.max);
-        s.input.value = map(s.input.value, s.input.min, s.input.max, 0, 255);
-		servoFilterValue[number] = filter(servoFilterValue[number], s.input.value, s.filter);
+    servoTicks[pin] = ticks;
+    servoDirty[pin / 16] |= (1 << (pin % 16));
+}
 
-        if (s.invert) {
-            s.value = map(servoFilterValue[number], 0, 255, s.max, s.min);
-        } else {
-            s.value = map(servoFilterValue[number], 0, 255, s.min, s.max);
+void queueServos() {
+    if (servosBusy()) {
+        // The previous frame is still on the bus, finish it so frames never overlap
+        recordOutputOverlap();
+
+        while (serviceServos()) {
+            // Drain previous frame
         }
+    }
+
+    uint16_t offset = 0;
 
-        servoBoard.setPin(s.pin, s.value);
+    memset(burstCount, 0, sizeof(burstCount));
+    memset(burstNext, 0, sizeof(burstNext));
+
+    for (uint8_t b = 0; b < boardCount; b++) {
+        uint8_t bus = boardBus[b];
+        uint16_t dirty = servoDirty[b];
+        uint8_t c = 0;
+
+        // One auto-increment write per run of staged channels instead of one transfer per channel
+        while (dirty != 0) {
+            if ((dirty & (1 << c)) == 0) {
+                c++;
+                continue;
+            }
+
+            burst_t &burst = burstQueue[bus][burstCount[bus]++];
+            uint8_t count = 0;
+
+            burst.board = b;
+            burst.offset = offset;
+            burstBytes[offset++] = PCA9685_LED0_ON_L + (c * 4);
+
+            while (count < I2C_BURST_CHANNELS && c < 16 && (dirty & (1 << c))) {
+                uint16_t ticks = servoTicks[(b * 16) + c];
+
+                burstBytes[offset++] = 0x00;  // On Low
+                burstBytes[offset++] = 0x00;  // On High
+                burstBytes[offset++] = ticks & 0xFF;  // Off Low
+                burstBytes[offset++] = (ticks >> 8) & 0x0F;  // Off High
+                dirty &= ~(1 << c);
+                count++;
+                c++;
+            }
+
+            burst.size = offset - burst.offset;
+        }
+
+        servoDirty[b] = 0;
+    }
+
+    // The first burst of each port goes out now, the rest follow from the frame loop
+    serviceServos();
+}
+
+bool serviceServos() {
+    bool busy = false;
+
+    for (uint8_t i = 0; i < I2C_BUSES; i++) {
+        // The interrupt sends the burst on the bus, this only starts the next one once the last has gone out
+        if (!i2cBus[i]->finished()) {
+            busy = true;
+            continue;
+        }
+
+        if (burstNext[i] >= burstCount[i]) {
+            continue;
+        }
+
+        const burst_t &burst = burstQueue[i][burstNext[i]++];
+        i2cBus[i]->write_async(boardAddress[burst.board], &burstBytes[burst.offset], burst.size, true);
+        busy = true;
+    }
+
+    return busy;
+}
+
+bool servosBusy() {
+    for (uint8_t i = 0; i < I2C_BUSES; i++) {
+        if (burstNext[i] < burstCount[i] || !i2cBus[i]->finished()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void flushServos() {
+    queueServos();
+
+    while (serviceServos()) {
+        // Send every burst before returning
+    }
+}
+
+void updateServo(uint8_t number) {
+    servo_t s = servo[number];
+
+    if (s.enabled) {
+        s.input.value = readInput(s.input.number);
+        playServoTicks(number, computeServo(number, s.input.value));
     }
 }
 
@@ -106,16 +409,15 @@ uint16_t minmaxServo(uint8_t pin, uint8_t servo) {
         if (millisNow - millisPrev >= 40) {
             millisPrev = millisNow;
 
-            i.value = analogRead(i.pin);
-            i.value = constrain(i.value, i.min, i.max);
-            i.value = map(i.value, i.min, i.max, 0, 255);
+            i.value = readInput(pin);
 
             servoValue = map(i.value, 0, 255, 0, 800);
 
             if (servoValue != servoValuePrev) {
                 servoValuePrev = servoValue;
 
-                servoBoard.setPin(servo, servoValue);
+                setServo(servo, servoValue);
+                flushServos();
                 Serial.print("Servo Position: ");
                 Serial.println(servoValue);
             }
@@ -133,38 +435,246 @@ uint16_t minmaxServo(uint8_t pin, uint8_t servo) {
 void recordServo(uint8_t number) {
     servo_t s = servo[number];
 
+    if (isLipsyncServo(number)) {
+        // The mouth comes from the audio, keep the puppeteer from recording over it
+        playServo(number);
+        return;
+    }
+
+    if (s.enabled) {
+        s.input.value = readInput(s.input.number);
+        recordTrack(getShowFrameCount(), number, s.input.value);
+        playServoTicks(number, computeServo(number, s.input.value));
+    }
+}
+
+void playServo(uint8_t number) {
+    servo_t s = servo[number];
+
     if (s.enabled) {
-        s.input.value = analogRead(s.input.pin);
-        s.input.value = constrain(s.input.value, s.input.min, s.input.max);
-        s.input.value = map(s.input.value, s.input.min, s.input.max, 0, 255);
-        saveData(getShowFrameCount() + (getShowMaxFrameCount() * number), s.input.value);
-		servoFilterValue[number] = filter(servoFilterValue[number], s.input.value, s.filter);
-
-        if (s.invert) {
-            s.value = map(servoFilterValue[number], 0, 255, s.max, s.min);
+        if (isLipsyncLive() && isLipsyncServo(number)) {
+            s.input.value = getAudioEnvelope();
+        } else if (isTrackCorrupt(getLeadFrame(getShowFrameCount(), number), number)) {
+            return;
         } else {
-            s.value = map(servoFilterValue[number], 0, 255, s.min, s.max);
+            s.input.value = getTrackValue(getLeadFrame(getShowFrameCount(), number), number);
         }
 
-        servoBoard.setPin(s.pin, s.value);
+        playServoTicks(number, computeServo(number, s.input.value));
     }
 }
 
-void playServo(uint8_t number) {
+/**
+*   @brief  Struct for the servo state playChannels() reads and the output it plays to
+*/
+struct playback_t {
+    bool live;
+
+    bool enabled(uint8_t s) {
+        return servo[s].enabled;
+    }
+
+    uint8_t lead(uint8_t s) {
+        return servo[s].lead;
+    }
+
+    void play(uint8_t s, uint8_t value) {
+        if (live && isLipsyncServo(s)) {
+            value = getAudioEnvelope();
+        }
+
+        playServoTicks(s, computeServo(s, value));
+    }
+};
+
+/**
+*   @brief  Play one frame of a show whose tracks have different rate divisors
+*
+*   @param  count   Number of servos, 0 ... 63
+*/
+void playResampled(uint8_t count) {
+    const bool live = isLipsyncLive();
+    const uint32_t frame = getShowFrameCount();
+
+    for (uint8_t s = 0; s < count; s++) {
+        if (!servo[s].enabled) {
+            continue;
+        }
+
+        bool fromAudio = live && isLipsyncServo(s);
+        uint32_t at = getLeadFrame(frame, s);
+
+        // A track read back wrong from the card holds the last pose instead of playing garbage
+        if (!fromAudio && isTrackCorrupt(at, s)) {
+            recordHeldServo();
+            continue;
+        }
+
+        uint8_t value = fromAudio ? getAudioEnvelope() : getTrackValue(at, s);
+        playServoTicks(s, computeServo(s, value));
+    }
+}
+
+void playFrame(uint8_t servoCount) {
+    // Tracks past the memory holding the show and corrupt ones hold, one servo at a time
+    if (!isShowUniform() || getTrackBytes() > getShowCapacity() || hasCorruptBlocks()) {
+        playResampled(servoCount);
+        return;
+    }
+
+    playback_t servos = {isLipsyncLive()};
+
+#ifdef FIXED_FIGURE_CHANNELS
+    static_assert(FIXED_FIGURE_CHANNELS > 0 && FIXED_FIGURE_CHANNELS <= MAX_SERVOS, "FIXED_FIGURE_CHANNELS must be 1 ... MAX_SERVOS");
+
+    if (servoCount == FIXED_FIGURE_CHANNELS) {
+        playChannels<FIXED_FIGURE_CHANNELS>(getShowTracks(), getShowFrameCount(), getShowMaxFrameCount(), servoCount, servos);
+        return;
+    }
+#endif
+
+    playChannels<0>(getShowTracks(), getShowFrameCount(), getShowMaxFrameCount(), servoCount, servos);
+}
+
+uint32_t getLeadFrame(uint32_t frame, uint8_t number) {
+    uint32_t maxFrames = getShowMaxFrameCount();
+    uint32_t lead = frame + servo[number].lead;
+
+    return (lead < maxFrames || maxFrames == 0) ? lead : maxFrames - 1;
+}
+
+uint16_t computeServo(uint8_t number, uint8_t value) {
     servo_t s = servo[number];
 
-    if (s.enabled) {
-        s.input.value = getData(getShowFrameCount() + (getShowMaxFrameCount() * number));
-		servoFilterValue[number] = filter(servoFilterValue[number], s.input.value, s.filter);
+    servoInputValue[number] = value;
+    servoFilterValue[number] = filter(servoFilterValue[number], value, s.filter);
+
+    if (s.invert) {
+        return map(servoFilterValue[number], 0, 255, s.max, s.min);
+    }
+
+    return map(servoFilterValue[number], 0, 255, s.min, s.max);
+}
+
+uint32_t isqrt(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
 
-        if (s.invert) {
-            s.value = map(servoFilterValue[number], 0, 255, s.max, s.min);
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
         } else {
-            s.value = map(servoFilterValue[number], 0, 255, s.min, s.max);
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+uint16_t profileServo(uint8_t number, uint16_t ticks) {
+    const profile_t &p = profile[number];
+    motion_t &m = motion[number];
+    int32_t target = (int32_t)ticks << 8;
+
+    if (p.velocity == 0 && p.accel == 0) {
+        m = {target, 0, 0};
+        return ticks;
+    }
+
+    int32_t distance = target - m.position;
+    int32_t velocity = distance;  // Arrive this frame if nothing limits it
+
+    if (p.velocity != 0) {
+        int32_t maxVelocity = (int32_t)p.velocity << 8;
+        velocity = constrain(velocity, -maxVelocity, maxVelocity);
+    }
+
+    if (p.accel != 0) {
+        int32_t maxAccel = (int32_t)p.accel << 6;
+
+        // Never go faster than can be stopped at the target in whole frames
+        int32_t brake = isqrt((2 * (uint64_t)maxAccel * abs(distance)) + ((uint64_t)maxAccel * maxAccel / 4)) - (maxAccel / 2);
+        velocity = constrain(velocity, -brake, brake);
+
+        int32_t accel = constrain(velocity - m.velocity, -maxAccel, maxAccel);
+
+        // Jerk limiting softens speeding up, braking is never held back so it cannot overshoot
+        bool speedingUp = (accel > 0 && m.velocity >= 0) || (accel < 0 && m.velocity <= 0);
+
+        if (p.jerk != 0 && speedingUp) {
+            int32_t maxJerk = (int32_t)p.jerk << 4;
+            int32_t from = ((accel > 0) == (m.accel > 0)) ? m.accel : 0;
+            accel = constrain(accel, from - maxJerk, from + maxJerk);
         }
 
-        servoBoard.setPin(s.pin, s.value);
+        m.accel = accel;
+        velocity = m.velocity + accel;
     }
+
+    m.velocity = velocity;
+    m.position += velocity;
+
+    uint16_t limited = constrain((m.position + 128) >> 8, 0, 4095);
+
+    if (abs((int32_t)limited - (int32_t)ticks) > 1) {
+        motionSaturated++;
+    }
+
+    return limited;
+}
+
+uint8_t takeMotionSaturation() {
+    uint8_t count = motionSaturated;
+    motionSaturated = 0;
+    return count;
+}
+
+void beginBlend(uint8_t frames) {
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
+        blendFrom[s] = servoTicks[servo[s].pin];
+    }
+
+    blendFrames = frames;
+    blendLeft = frames;
+}
+
+void stepBlend() {
+    if (blendLeft > 0) {
+        blendLeft--;
+    }
+}
+
+void playServoTicks(uint8_t number, uint16_t ticks) {
+    if (servo[number].enabled) {
+        if (blendLeft > 0) {
+            int32_t from = blendFrom[number];
+            ticks = from + (((ticks - from) * (int32_t)(blendFrames - blendLeft + 1)) / (blendFrames + 1));
+        }
+
+        setServo(servo[number].pin, profileServo(number, ticks));
+    }
+}
+
+void getServoTelemetry(uint8_t number, uint16_t* ticks, uint8_t* value, uint8_t* filtered) {
+    *ticks = servoTicks[servo[number].pin];
+    *value = servoInputValue[number];
+    *filtered = servoFilterValue[number];
+}
+
+void primeServo(uint8_t number) {
+    // A track that can not be played leaves the filter where the servo is
+    if (isTrackCorrupt(getShowFrameCount(), number)) {
+        return;
+    }
+
+    servoFilterValue[number] = getTrackValue(getShowFrameCount(), number);
 }
 
 float filter(float servoValue, float inputValue, uint8_t filter) {
@@ -6,19 +6,36 @@
 #ifndef SERVO_H_
     #define SERVO_H_
 
+    #include "layout.h"
     #include <Arduino.h>
 
+    #define CURVE_POINTS 4
+    #define INPUT_TABLE_SIZE 1024  // One entry per 10 bit analogRead() value
+    // #define FIXED_FIGURE_CHANNELS 16  // Build the show frame loop for a figure with exactly this many servos
+
     /**
     *   @brief  Struct for Input settings
     */
     struct input_t {
         bool enabled;
+        uint8_t number;
         uint8_t pin;
         uint16_t min;
         uint16_t max;
         uint16_t value;
     };
 
+    /**
+    *   @brief  Struct for the calibration curve of an input between its min and max
+    *
+    *   Each point maps a raw reading to a value, min maps to 0 and max to 255.
+    *   Readings in between are joined by straight lines, a reading of 0 marks an unused point.
+    */
+    struct __attribute__((packed)) curve_t {
+        uint16_t reading[CURVE_POINTS];
+        uint8_t value[CURVE_POINTS];
+    };
+
     /**
     *   @brief  Struct for Servo settings
     */
@@ -31,6 +48,24 @@
 		uint8_t filter;
         input_t input;
         bool invert;
+        uint8_t lead;  // Frames the track is read ahead to make up for the servo's lag
+    };
+
+    /**
+    *   @brief  Struct for the motion limits of a servo, 0 turns a limit off
+    */
+    struct profile_t {
+        uint8_t velocity;  // Ticks per frame
+        uint8_t accel;  // 1/4 ticks per frame per frame
+        uint8_t jerk;  // 1/16 ticks per frame per frame per frame
+    };
+
+    /**
+    *   @brief  Struct for the lag of a servo, in show frames
+    */
+    struct latency_t {
+        uint8_t play;  // Frames the servo moves after it is told to, playback reads this far ahead
+        uint8_t record;  // Frames the puppeteer is behind the audio, recorded data is moved this far earlier
     };
 
     /**
@@ -39,10 +74,23 @@
     void setupServos(void);
 
     /**
-    *   @brief  Load input data from the config file to an array
+    *   @brief  Apply the loaded config to the running servos without centering them
+    */
+    void reloadServos(void);
+
+    /**
+    *   @brief  Load input data from the config file to an array and build each input's calibration table
     */
     void processInputs(void);
 
+    /**
+    *   @brief  Read a given input through its calibration table
+    *
+    *   @param  number  Input number, 0 ... 15
+    *   @return Returns the calibrated value, 0 ... 255
+    */
+    uint8_t readInput(uint8_t number);
+
     /**
     *   @brief  Get the total number of inputs from the config file
     *
@@ -58,7 +106,7 @@
     /**
     *   @brief  Get the total number of servos from the config file
     *
-    *   @return Returns the total number of servos, 0 ... 15
+    *   @return Returns the total number of servos, 0 ... 64
     */
     uint8_t getServoCount(void);
 
@@ -67,10 +115,45 @@
     */
     void centerServos(void);
 
+    /**
+    *   @brief  Stage a servo position, sent to the board on the next flushServos()
+    *
+    *   @param  pin     Servo pin to write, 0 ... (boards * 16) - 1, pins past the last board are ignored
+    *   @param  ticks   Servo position, 0 ... 4095
+    */
+    void setServo(uint8_t pin, uint16_t ticks);
+
+    /**
+    *   @brief  Queue all staged servo positions for sending, one burst per run of channels on each board
+    *
+    *   The first burst starts on the bus before returning. If the previous frame is still being
+    *   sent it is finished first, so frames never overlap
+    */
+    void queueServos(void);
+
+    /**
+    *   @brief  Start the next queued burst once the bus is free, returns at once, call from the frame loop while waiting for the next frame
+    *
+    *   @return ```true``` if a burst is on the bus or still queued and ```false``` if the frame has been sent
+    */
+    bool serviceServos(void);
+
+    /**
+    *   @brief  Check if the last queued frame is still being sent
+    *
+    *   @return ```true``` if a burst is on the bus or still queued and ```false``` if the frame is complete
+    */
+    bool servosBusy(void);
+
+    /**
+    *   @brief  Queue and send all staged servo positions before returning
+    */
+    void flushServos(void);
+
     /**
     *   @brief  Read a given servo input and update its position
     *
-    *   @param  number  Servo number to update, 0 ... 15
+    *   @param  number  Servo number to update, 0 ... 63
     */
     void updateServo(uint8_t number);
 
@@ -78,7 +161,7 @@
     *   @brief  Configure servo Min/Max
     *
     *   @param  pin Input pin to read, 0 ... 15
-    *   @param  servo   Servo pin to write, 0 ... 15
+    *   @param  servo   Servo pin to write, 0 ... 63
     *   @return Returns the servo position as uint16_t, 150 ... 600
     */
     uint16_t minmaxServo(uint8_t pin, uint8_t servo);
@@ -86,17 +169,109 @@
     /**
     *   @brief  Read a given servo input, save it to the show file and update its position
     *
-    *   @param  number  Servo number to record, 0 ... 15
+    *   @param  number  Servo number to record, 0 ... 63
     */
     void recordServo(uint8_t number);
 
     /**
     *   @brief  Read a given servo from the show file and update its position
     *
-    *   @param  number  Servo number to play, 0 ... 15
+    *   @param  number  Servo number to play, 0 ... 63
     */
     void playServo(uint8_t number);
+
+    /**
+    *   @brief  Play every servo from the current show frame
+    *
+    *   @param  servoCount  Number of servos, 0 ... 63
+    */
+    void playFrame(uint8_t servoCount);
 	
+    /**
+    *   @brief  Get the show frame a given servo plays on a frame, its lead ahead and held at the end
+    *
+    *   @param  frame   Frame number, 0x0000 ... 0xFFE0
+    *   @param  number  Servo number, 0 ... 63
+    *   @return Returns the frame of the track to play
+    */
+    uint32_t getLeadFrame(uint32_t frame, uint8_t number);
+
+    /**
+    *   @brief  Run a show value through the filter, invert and min / max of a given servo
+    *
+    *   @param  number  Servo number, 0 ... 63
+    *   @param  value   Show value, 0 ... 255
+    *   @return Returns the servo position, 0 ... 4095
+    */
+    uint16_t computeServo(uint8_t number, uint8_t value);
+
+    /**
+    *   @brief  Integer square root, safe to call from the audio interrupt
+    *
+    *   @param  value   Value to take the root of
+    *   @return Returns the largest root whose square is <= value
+    */
+    uint32_t isqrt(uint64_t value);
+
+    /**
+    *   @brief  Run a position through the velocity, acceleration and jerk limits of a given servo
+    *
+    *   Called once per servo per output tick. State is kept in 1/256 ticks so slow limits still move.
+    *
+    *   @param  number  Servo number, 0 ... 63
+    *   @param  ticks   Target servo position, 0 ... 4095
+    *   @return Returns the limited servo position, 0 ... 4095
+    */
+    uint16_t profileServo(uint8_t number, uint16_t ticks);
+
+    /**
+    *   @brief  Start a crossfade from the pose the servos are in to whatever is played next
+    *
+    *   @param  frames  Number of frames to crossfade over, 0 ... 255, 0 snaps straight to the next pose
+    */
+    void beginBlend(uint8_t frames);
+
+    /**
+    *   @brief  Advance the crossfade by one frame, call once per frame after queueServos()
+    */
+    void stepBlend(void);
+
+    /**
+    *   @brief  Get the number of servos held back by their motion limits since the last call
+    *
+    *   @return Returns the number of saturated servos, 0 ... 64
+    */
+    uint8_t takeMotionSaturation(void);
+
+    /**
+    *   @brief  Send an already computed position to a given servo if it is enabled
+    *
+    *   Every output goes through here, so the crossfade and the motion profile apply to all of them
+    *
+    *   @param  number  Servo number, 0 ... 63
+    *   @param  ticks   Servo position, 0 ... 4095
+    */
+    void playServoTicks(uint8_t number, uint16_t ticks);
+
+    /**
+    *   @brief  Set the filter of a given servo to the show data at the current frame
+    *
+    *   Used after a seek so the servo goes straight to the new position instead of easing in
+    *
+    *   @param  number  Servo number to prime, 0 ... 63
+    */
+    void primeServo(uint8_t number);
+
+    /**
+    *   @brief  Get the live state of a given servo for the telemetry stream
+    *
+    *   @param  number      Servo number, 0 ... 63
+    *   @param  ticks       Returns the last commanded PWM ticks, 0 ... 4095
+    *   @param  value       Returns the last input or show value, 0 ... 255
+    *   @param  filtered    Returns the filtered value, 0 ... 255
+    */
+    void getServoTelemetry(uint8_t number, uint16_t* ticks, uint8_t* value, uint8_t* filtered);
+
     /**
     *   @brief  Filter servo value for smoothing
     *
@@ -6,30 +6,386 @@
 #include "show.h"
 #include "audio.h"
 #include "config.h"
+#include "crc.h"
+#include "events.h"
+#include "idle.h"
 #include "interface.h"
+#include "layout.h"
+#include "lipsync.h"
+#include "memory.h"
+#include "render.h"
+#include "sdio.h"
 #include "servo.h"
+#include "soak.h"
+#include "storage.h"
+#include "sync.h"
+#include "telemetry.h"
+#include "timing.h"
+#include "trigger.h"
 #include <SD.h>
 
-#define SAMPLE_RATE 10  // 10fps 100ms | 20fps 50ms | 25fps 40ms | 40fps 25ms | 50fps 20ms
-#define SHOW_BYTE_SIZE 0xFFFF
+#define FRAME_US (SAMPLE_RATE * 1000)
+#define COMMAND_SLACK_US 500  // Serial commands only run with at least this long until the next frame
+#define HEADER_SECTOR (SHOW_SIZE - SECTOR_SIZE)
+#define INDEX_BLOCKS (SHOW_SIZE / INDEX_BLOCK_FRAMES)
 char fileName[8] = "";
 File SHOW_FILE;
-uint8_t program[SHOW_BYTE_SIZE + 1] = {};
+uint8_t* program = allocArena(SECTOR_SIZE);  // Servo tracks, followed by the header sector
+uint8_t* showHeader = program;  // The last sector of the show file
+uint32_t trackCapacity = 0;  // Bytes of servo tracks held in memory, the rest of the show data is not used
+uint32_t trackLimit = 0;  // First address past the tracks in memory
+uint32_t dirtyStart = SHOW_SIZE;
+uint32_t dirtyEnd = 0;
+bool chunksDirty = false;
+uint32_t showKey = 0;
+bool showKeyValid = false;
+uint16_t blockIndex[INDEX_BLOCKS];  // First event of each block of frames
+bool indexValid = false;
+bool showOnDisk = false;
+uint8_t showOnDiskNumber = 0;
+uint8_t showMap[32];  // One bit per show file on the card
+bool showRendered = false;
+bool showStopped = false;
+bool showPaused = false;
 uint32_t showFrameCount = 0;
 uint32_t showServoMaxFrameCount = 0;
 uint32_t showMaxFrameCount = 0;
 uint32_t millisNow = 0;
 uint32_t millisPrev = 0;
+uint32_t microsNow = 0;
+uint32_t microsPrev = 0;
+bool eventsPending = false;  // Events of the last frame wait for its servo output to leave the bus
+uint32_t eventsPendingMS = 0;
+uint32_t eventsFrameStart = 0;
+uint8_t trackDivisor[MAX_SERVOS];  // Show frames per stored sample, 1 stores every frame
+uint32_t trackStart[MAX_SERVOS + 1];
+bool tracksUniform = true;
+uint32_t blockCrc[CRC_BLOCKS];  // CRC-32 of each block of show data as it is on the card
+bool blockCrcValid = false;
+uint8_t blockBad[CRC_BLOCKS / 8];  // One bit per block that did not match its CRC when loaded
+uint8_t blockBadCount = 0;
+
+static_assert(CRC_BLOCK_SIZE == SECTOR_SIZE, "Block CRCs must be taken one sector at a time");
+
+void markDirty(uint32_t address, uint32_t size) {
+    showKeyValid = false;
+    dirtyStart = min(dirtyStart, address);
+    dirtyEnd = max(dirtyEnd, address + size);
+}
+
+void markClean(uint8_t number) {
+    dirtyStart = SHOW_SIZE;
+    dirtyEnd = 0;
+    chunksDirty = false;
+    showOnDisk = true;
+    showOnDiskNumber = number;
+}
+
+void markChunksDirty() {
+    chunksDirty = true;
+    indexValid = false;
+}
+
+void buildIndex() {
+    for (uint16_t b = 0; b < INDEX_BLOCKS; b++) {
+        blockIndex[b] = findEvent(b * INDEX_BLOCK_FRAMES * SAMPLE_RATE);
+    }
+
+    indexValid = true;
+}
+
+void loadIndex(uint32_t size) {
+    uint8_t data[2];
+    uint16_t b = 0;
+
+    while (size >= 2 && b < INDEX_BLOCKS && SHOW_FILE.read(data, 2) == 2) {
+        blockIndex[b++] = (data[1] << 8) + data[0];
+        size -= 2;
+    }
+
+    while (b < INDEX_BLOCKS) {
+        blockIndex[b++] = getEventCount();
+    }
+
+    SHOW_FILE.seek(SHOW_FILE.position() + size);
+    indexValid = true;
+}
+
+bool saveIndex() {
+    uint16_t blocks = (showMaxFrameCount / INDEX_BLOCK_FRAMES) + 1;
+
+    if (!writeChunkHeader(CHUNK_INDEX, blocks * 2)) {
+        return false;
+    }
+
+    for (uint16_t b = 0; b < blocks; b++) {
+        uint8_t data[2] = {(uint8_t)(blockIndex[b] & 0xFF), (uint8_t)(blockIndex[b] >> 8)};
+
+        if (!writeSave(data, 2)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+*   @brief  Work out where each track starts from the show length and the rate divisors
+*/
+void layoutTracks() {
+    tracksUniform = true;
+    trackStart[0] = 0;
+
+    for (uint8_t n = 0; n < MAX_SERVOS; n++) {
+        trackDivisor[n] = max(trackDivisor[n], (uint8_t)1);
+        tracksUniform = tracksUniform && (trackDivisor[n] == 1);
+        trackStart[n + 1] = trackStart[n] + showTrackLength(showMaxFrameCount, trackDivisor[n]);
+    }
+}
+
+/**
+*   @brief  Set every track back to one sample per frame
+*/
+void resetTracks() {
+    memset(trackDivisor, 1, sizeof(trackDivisor));
+    layoutTracks();
+}
+
+void loadRates(uint32_t size) {
+    uint32_t count = min(size, (uint32_t)sizeof(trackDivisor));
+
+    SHOW_FILE.read(trackDivisor, count);
+    SHOW_FILE.seek(SHOW_FILE.position() + (size - count));
+}
+
+bool saveRates() {
+    if (tracksUniform) {
+        return true;
+    }
+
+    return writeChunkHeader(CHUNK_RATES, sizeof(trackDivisor)) && writeSave(trackDivisor, sizeof(trackDivisor));
+}
+
+void loadCrcs(uint32_t size) {
+    uint8_t data[4];
+
+    if (size != sizeof(blockCrc)) {
+        SHOW_FILE.seek(SHOW_FILE.position() + size);
+        return;
+    }
+
+    for (uint8_t b = 0; b < CRC_BLOCKS && SHOW_FILE.read(data, 4) == 4; b++) {
+        blockCrc[b] = (data[3] << 24) + (data[2] << 16) + (data[1] << 8) + data[0];
+    }
+
+    blockCrcValid = true;
+}
+
+bool saveCrcs() {
+    if (!writeChunkHeader(CHUNK_CRCS, sizeof(blockCrc))) {
+        return false;
+    }
+
+    for (uint8_t b = 0; b < CRC_BLOCKS; b++) {
+        uint8_t data[4] = {(uint8_t)(blockCrc[b] & 0xFF), (uint8_t)((blockCrc[b] >> 8) & 0xFF),
+            (uint8_t)((blockCrc[b] >> 16) & 0xFF), (uint8_t)(blockCrc[b] >> 24)};
+
+        if (!writeSave(data, 4)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+*   @brief  Compare the CRCs taken while reading the tracks with the ones saved with the show
+*
+*   @param  readCrc CRC-32 of each sector read into memory
+*/
+void checkBlocks(const uint32_t* readCrc) {
+    memset(blockBad, 0, sizeof(blockBad));
+    blockBadCount = 0;
+
+    if (!blockCrcValid) {
+        return;
+    }
+
+    for (uint8_t b = 0; b < CRC_BLOCKS; b++) {
+        uint32_t address = b * CRC_BLOCK_SIZE;
+
+        if (address >= trackLimit) {
+            break;
+        }
+
+        // The last block shares its sector with the header, it was read with the header
+        uint32_t crc = (address < HEADER_SECTOR) ? readCrc[b] : crc32(0, showHeader, crcBlockSize(b));
+
+        if (crc != blockCrc[b]) {
+            blockBad[b / 8] |= (1 << (b % 8));
+            blockBadCount++;
+        }
+    }
+}
+
+/**
+*   @brief  Take the CRC of each block in memory that changed since the show was loaded or saved
+*/
+void stampBlocks() {
+    uint32_t from = blockCrcValid ? dirtyStart : 0;
+    uint32_t to = blockCrcValid ? min(dirtyEnd, trackCapacity) : trackCapacity;
+
+    for (uint32_t address = from & ~(CRC_BLOCK_SIZE - 1); address < to; address += CRC_BLOCK_SIZE) {
+        blockCrc[address / CRC_BLOCK_SIZE] = crc32(0, program + address, CRC_BLOCK_SIZE);
+    }
+
+    // Track bytes in the header sector live with the header whether or not they are in use
+    blockCrc[CRC_BLOCKS - 1] = crc32(0, showHeader, crcBlockSize(CRC_BLOCKS - 1));
+}
+
+void loadChunks() {
+    uint8_t header[8];
+    bool eventsAsStored = true;
+
+    while (SHOW_FILE.available() >= 8 && SHOW_FILE.read(header, sizeof(header)) == sizeof(header)) {
+        uint32_t size = (header[7] << 24) + (header[6] << 16) + (header[5] << 8) + header[4];
+
+        if (memcmp(header, CHUNK_EVENTS, 4) == 0) {
+            eventsAsStored = loadEvents(SHOW_FILE, size);
+        } else if (memcmp(header, CHUNK_INDEX, 4) == 0) {
+            loadIndex(size);
+        } else if (memcmp(header, CHUNK_RATES, 4) == 0) {
+            loadRates(size);
+        } else if (memcmp(header, CHUNK_CRCS, 4) == 0) {
+            loadCrcs(size);
+        } else {
+            SHOW_FILE.seek(SHOW_FILE.position() + size);
+        }
+    }
+
+    // A stored index points at events as they were in the file, so it is rebuilt if any moved
+    if (!eventsAsStored) {
+        indexValid = false;
+    }
+}
+
+/**
+*   @brief  Make room for a given amount of servo tracks, the header is kept and the tracks are cleared
+*
+*   @param  trackBytes  Bytes of servo tracks the show uses
+*   @return ```true``` if the tracks fit in memory and ```false``` if there is only room for the header
+*/
+bool sizeShow(uint32_t trackBytes) {
+    uint8_t header[SECTOR_SIZE];
+    memcpy(header, showHeader, SECTOR_SIZE);
+
+    // Whole sectors, a show that reaches the header sector shares it with the header
+    uint32_t capacity = min((trackBytes + SECTOR_SIZE - 1) & ~(SECTOR_SIZE - 1), (uint32_t)HEADER_SECTOR);
+    program = allocArena(capacity + SECTOR_SIZE);
+    bool fits = (program != NULL);
+
+    if (!fits) {
+        capacity = 0;
+        program = allocArena(SECTOR_SIZE);
+    }
+
+    trackCapacity = capacity;
+    trackLimit = (capacity == HEADER_SECTOR) ? SHOW_HEADER : capacity;
+    showHeader = program + capacity;
+    memcpy(showHeader, header, SECTOR_SIZE);
+    memset(program, 0, capacity);
+    showKeyValid = false;
+
+    return fits;
+}
+
+bool growShow() {
+    uint32_t capacity = min((getTrackBytes() + SECTOR_SIZE - 1) & ~(SECTOR_SIZE - 1), (uint32_t)HEADER_SECTOR);
+
+    if (capacity <= trackCapacity) {
+        return true;
+    }
+
+    uint8_t header[SECTOR_SIZE];
+    memcpy(header, showHeader, SECTOR_SIZE);
+
+    uint8_t* grown = resizeArena(capacity + SECTOR_SIZE);
+
+    if (grown == NULL) {
+        return false;
+    }
+
+    uint32_t kept = trackCapacity;
+    program = grown;
+    trackCapacity = capacity;
+    trackLimit = (capacity == HEADER_SECTOR) ? SHOW_HEADER : capacity;
+    showHeader = program + capacity;
+    memcpy(showHeader, header, SECTOR_SIZE);
+    memset(program + kept, 0, capacity - kept);
+    showKeyValid = false;
+
+    // The sectors that just came into memory are still on the card if the show was saved
+    if (showOnDisk) {
+        char restName[8] = "";
+        sprintf(restName, "%03d.ANI", showOnDiskNumber);
+
+        File file = SD.open(restName);
+
+        if (file) {
+            file.seek(kept);
+            readBlocks(file, program + kept, capacity - kept);
+            file.close();
+        }
+    }
+
+    return true;
+}
+
+/**
+*   @brief  Copy the show data past the tracks in memory from the show file on the card to the open save
+*
+*   @return ```true``` if the data was written and ```false``` if there was an error
+*/
+bool saveRest() {
+    char restName[8] = "";
+    sprintf(restName, "%03d.ANI", showOnDiskNumber);
+
+    File file;
+    uint8_t data[SECTOR_SIZE] = {};
+
+    if (showOnDisk) {
+        file = SD.open(restName);
+        file.seek(trackCapacity);
+    }
+
+    for (uint32_t address = trackCapacity; address < HEADER_SECTOR; address += SECTOR_SIZE) {
+        if (file && readBlocks(file, data, SECTOR_SIZE) != SECTOR_SIZE) {
+            memset(data, 0, SECTOR_SIZE);
+        }
+
+        blockCrc[address / CRC_BLOCK_SIZE] = crc32(0, data, SECTOR_SIZE);
+
+        if (!writeSave(data, SECTOR_SIZE)) {
+            return false;
+        }
+    }
+
+    if (file) {
+        file.close();
+    }
+
+    return true;
+}
 
 void newShow() {
-    program[0xFFE8] = 0xA9;
-    program[0xFFE9] = 0x32;
-    program[0xFFEA] = 0x30;
-    program[0xFFEB] = 0x31;
-    program[0xFFEC] = 0x39;
-    program[0xFFED] = 0x20;
-    program[0xFFEE] = 0x43;
-    program[0xFFEF] = 0x43;
+    showOnDisk = false;
+    blockCrcValid = false;
+    memset(blockBad, 0, sizeof(blockBad));
+    blockBadCount = 0;
+    markDirty(0, SHOW_SIZE);
+    clearEvents();
+
+    memcpy(showHeader + (SHOW_MAGIC - HEADER_SECTOR), SHOW_MAGIC_DATA, sizeof(SHOW_MAGIC_DATA));
 
     Serial.print("\nEnter show number 0-255: ");
     setShowNumber(getInt());
@@ -52,11 +408,36 @@ void newShow() {
     }
 
     showMaxFrameCount = getShowMS() / SAMPLE_RATE;
+    resetTracks();
+
+    Serial.print("Set channel rates? 'y' or 'n' ");
 
-    if ((showMaxFrameCount * getInputCount()) > (SHOW_BYTE_SIZE - 0x20)) {
+    if (getChar() == 'y') {
+        uint8_t servoCount = getServoCount();
+
+        for (uint8_t s = 0; s < servoCount; s++) {
+            Serial.print("Servo #");
+            Serial.print(s);
+            Serial.print(" frames per sample 1-255 (1 = every ");
+            Serial.print(SAMPLE_RATE);
+            Serial.print("ms): ");
+            trackDivisor[s] = constrain(getInt(), 1, 255);
+        }
+
+        layoutTracks();
+    }
+
+    if (getTrackBytes() > SHOW_HEADER) {
         Serial.println("Record time is too long");
     }
 
+    if (!sizeShow(getTrackBytes())) {
+        Serial.println("Not enough memory for the show");
+        return;
+    }
+
+    bakeLipsync();
+
     Serial.println("\nRecording in...");
     delay(1000);
     Serial.println("3...");
@@ -69,31 +450,105 @@ void newShow() {
     recordShow();
 }
 
+void scanShows() {
+    File root = SD.open("/");
+
+    memset(showMap, 0, sizeof(showMap));
+
+    // One pass over the directory instead of an SD.exists() per show number
+    while (File entry = root.openNextFile()) {
+        const char* name = entry.name();
+
+        if (!entry.isDirectory() && strlen(name) == 7 && strcasecmp(name + 3, ".ANI") == 0 &&
+            isdigit(name[0]) && isdigit(name[1]) && isdigit(name[2])) {
+            uint16_t number = atoi(name);
+
+            if (number < 256) {
+                showMap[number / 8] |= (1 << (number % 8));
+            }
+        }
+
+        entry.close();
+    }
+
+    root.close();
+}
+
+bool showExists(uint8_t number) {
+    return showMap[number / 8] & (1 << (number % 8));
+}
+
 bool loadShow(uint8_t number) {
+    uint32_t loadStartUS = micros();
     sprintf(fileName, "%03d.ANI", number);
+    recoverSave(fileName);
 
     if (SD.exists(fileName)) {
         SHOW_FILE = SD.open(fileName);
 
         if (SHOW_FILE) {
-            while (SHOW_FILE.available()) {
-                SHOW_FILE.read(program, sizeof(program));
+            // Header and chunks first, so only the frames and servos the show uses are read
+            sizeShow(0);
+            SHOW_FILE.seek(HEADER_SECTOR);
+            readBlocks(SHOW_FILE, showHeader, SECTOR_SIZE);
+
+            showMaxFrameCount = getShowMS() / SAMPLE_RATE;
+            showKeyValid = false;
+            clearEvents();
+            indexValid = false;
+            blockCrcValid = false;
+            memset(trackDivisor, 1, sizeof(trackDivisor));
+
+            if (showHeader[SHOW_VERSION_BYTE - HEADER_SECTOR] >= 1) {
+                SHOW_FILE.seek(SHOW_SIZE);
+                loadChunks();
+            }
+
+            layoutTracks();
+
+            uint32_t trackBytes = getTrackBytes();
+
+            if (!sizeShow(trackBytes)) {
+                SHOW_FILE.close();
+                Serial.print("Not enough memory for: ");
+                Serial.println(fileName);
+                return false;
+            }
+
+            // Each sector is checked as it comes in, so a flaky card costs no second pass
+            uint32_t readCrc[CRC_BLOCKS];
+
+            // A sector a short read never reached keeps a CRC that can not match the saved one
+            for (uint8_t b = 0; b < CRC_BLOCKS; b++) {
+                readCrc[b] = ~blockCrc[b];
+            }
+
+            SHOW_FILE.seek(0);
+            readBlocksChecked(SHOW_FILE, program, trackCapacity, readCrc);
+            checkBlocks(readCrc);
+            recordCorruptBlocks(blockBadCount);
+
+            if (!indexValid) {
+                buildIndex();
             }
 
             SHOW_FILE.close();
+            markClean(number);
 
             Serial.print("Loaded: ");
             Serial.println(fileName);
 
-            showMaxFrameCount = getShowMS() / SAMPLE_RATE;
+            if (blockBadCount > 0) {
+                Serial.print("Corrupt blocks, servos hold their last pose: ");
+                Serial.println(blockBadCount);
+            }
 
-            if ((showMaxFrameCount * getInputCount()) > (SHOW_BYTE_SIZE - 0x20)) {
+            if (trackBytes > SHOW_HEADER) {
                 Serial.println("Record time is too long");
                 return false;
             }
 
-            delay(100);
-
+            recordSoakLoad(micros() - loadStartUS);
             return true;
         } else {
             Serial.print("Error opening: ");
@@ -110,29 +565,59 @@ bool loadShow(uint8_t number) {
 
 void saveShow() {
     sprintf(fileName, "%03d.ANI", getShowNumber());
+    bool exists = SD.exists(fileName);
 
-    if (SD.exists(fileName)) {
+    if (exists) {
         Serial.print("Show ");
         Serial.print(fileName);
         Serial.print(" already exists. Overwrite? 'y' or 'n' ");
 
         switch (getChar()) {
             case 'y':
-                SD.remove(fileName);
                 break;
             default:
+                return;
                 break;
         }
     }
 
-    SHOW_FILE = SD.open(fileName, FILE_WRITE);
+    bool sameShow = exists && showOnDisk && (showOnDiskNumber == getShowNumber());
 
-    if (SHOW_FILE) {
-        SHOW_FILE.write(program, sizeof(program));
-        SHOW_FILE.close();
-    } else {
-        Serial.print("Error opening: ");
-        Serial.println(fileName);
+    if (sameShow && dirtyEnd == 0 && !chunksDirty) {
+        return;
+    }
+
+    if (sameShow && dirtyStart >= SHOW_HEADER && !chunksDirty) {
+        // Only the header changed, rewrite the last sector in place
+        if (writeInPlace(fileName, HEADER_SECTOR, showHeader, SECTOR_SIZE)) {
+            markClean(getShowNumber());
+        }
+
+        return;
+    }
+
+    showHeader[SHOW_VERSION_BYTE - HEADER_SECTOR] = tracksUniform ? 1 : SHOW_VERSION;
+
+    if (!indexValid) {
+        buildIndex();
+    }
+
+    stampBlocks();
+
+    if (beginSave(fileName)) {
+        // Tracks in memory, then the rest of the show data, then the header sector
+        bool written = writeSave(program, trackCapacity) && saveRest() && writeSave(showHeader, SECTOR_SIZE);
+
+        if (written && saveEvents() && saveIndex() && saveRates() && saveCrcs()) {
+            blockCrcValid = true;
+
+            if (commitSave()) {
+                markClean(getShowNumber());
+                showMap[getShowNumber() / 8] |= (1 << (getShowNumber() % 8));
+            }
+        } else {
+            abortSave();
+        }
     }
 }
 
@@ -147,6 +632,7 @@ void deleteShow() {
         switch (getChar()) {
             case 'y':
                 SD.remove(fileName);
+                showMap[getShowNumber() / 8] &= ~(1 << (getShowNumber() % 8));
                 break;
             default:
                 break;
@@ -154,34 +640,238 @@ void deleteShow() {
     }
 }
 
+void seekShow(uint32_t ms) {
+    showFrameCount = min(ms / SAMPLE_RATE, showMaxFrameCount);
+    eventsPending = false;
+
+    if (!indexValid) {
+        buildIndex();
+    }
+
+    // The block index gets the event cursor close in one lookup, the rest of the block is scanned
+    seekEventsFrom(blockIndex[showFrameCount / INDEX_BLOCK_FRAMES], showFrameCount * SAMPLE_RATE);
+
+    uint8_t servoCount = getServoCount();
+
+    for (uint8_t s = 0; s < servoCount; s++) {
+        primeServo(s);
+    }
+}
+
+void stopShow() {
+    showStopped = true;
+}
+
+void pauseShow(bool paused) {
+    if (paused == showPaused) {
+        return;
+    }
+
+    showPaused = paused;
+
+    if (paused) {
+        pauseAudio();
+    } else {
+        // Carry on from the same frame as soon as the loop sees it
+        startAudio();
+        microsPrev = micros() - FRAME_US;
+    }
+}
+
+bool isShowPaused() {
+    return showPaused;
+}
+
+bool isShowStopped() {
+    return showStopped;
+}
+
+void printShowStatus() {
+    Serial.print("\nShow #");
+    Serial.print(getShowNumber());
+    Serial.print(" | ");
+    Serial.print(showFrameCount * SAMPLE_RATE);
+    Serial.print(" / ");
+    Serial.print(getShowMS());
+    Serial.print(" ms | ");
+    Serial.print(showPaused ? "Paused" : "Playing");
+    Serial.print(" | Volume: ");
+    Serial.print(getVolume());
+    Serial.print("% | Audio buffered ms: ");
+    Serial.println(getAudioBufferedMS());
+}
+
 void playShow() {
-    showFrameCount = 0;
+    playShowAt(0);
+}
+
+void playShowAt(uint32_t ms) {
+    armShow(ms);
+    startAudio();
+    runShow();
+}
+
+void armShow(uint32_t ms) {
+    seekShow(ms);
+    resetTiming();
+    takeMotionSaturation();
+    resetIO();
+    resetSync();
+    showRendered = openRender(showFrameCount);
+    cueAudio(showFrameCount * SAMPLE_RATE);
+}
+
+/**
+*   @brief  Fire the events of the last frame once its servo output has been sent
+*
+*   Called when the burst queue has emptied, so events and servos change on the same frame
+*/
+void firePendingEvents() {
+    if (!eventsPending) {
+        return;
+    }
+
+    eventsPending = false;
+    uint16_t fired = playEvents(eventsPendingMS);
+
+    if (fired > 0) {
+        recordEventTiming(micros() - eventsFrameStart, fired);
+    }
+}
+
+void runShow() {
     uint8_t servoCount = getServoCount();
+    int32_t frameCorrection = 0;
+    bool rendered = showRendered;
 
-    playAudio();
+    showStopped = false;
+    showPaused = false;
 
-    while (showFrameCount < showMaxFrameCount) {
-        millisNow = millis();
+    // Fade from wherever the figure is, the last show or the idle motion, into the first frame
+    stopIdle();
+    beginBlend(getIdleData().blend);
+    microsPrev = micros() - FRAME_US;
 
-        if (millisNow - millisPrev >= SAMPLE_RATE) {
-            millisPrev = millisNow;
+    while (showFrameCount < showMaxFrameCount && !showStopped) {
+        microsNow = micros();
+        uint32_t frameUS = FRAME_US + frameCorrection;
 
-            for (uint8_t s = 0; s < servoCount; s++) {
-                playServo(s);
+        if (!showPaused && microsNow - microsPrev >= frameUS) {
+            uint32_t frameStart = micros();
+            uint32_t frameLate = microsNow - microsPrev - frameUS;
+
+            // Step by whole frame periods so late frames do not push every later frame back
+            microsPrev = (frameLate < frameUS) ? (microsPrev + frameUS) : microsNow;
+
+            sendSync(getShowNumber(), showFrameCount);
+
+            bool cached = rendered && playRender(showFrameCount);
+
+            if (!cached) {
+                playFrame(servoCount);
             }
 
+            recordMotionSaturation(showFrameCount, takeMotionSaturation());
+
+            // A frame still on the bus is finished by queueServos(), its events go out before the new bursts
+            queueServos();
+            firePendingEvents();
+            stepBlend();
+            markMotion();
+
+            // Events fire once the last burst of this frame has been sent, not while it is still queued
+            eventsPending = true;
+            eventsPendingMS = (showFrameCount + 1) * SAMPLE_RATE;
+            eventsFrameStart = frameStart;
+
+            recordFrameTiming(frameLate, micros() - frameStart);
+            recordTelemetry(showFrameCount, servoCount, frameLate, micros() - frameStart, cached);
             showFrameCount++;
+        } else {
+            serviceServos();
+
+            if (!servosBusy()) {
+                firePendingEvents();
+            }
+
+            serviceIO();
+
+            if (rendered) {
+                serviceRender();
+            }
+
+            serviceTelemetry();
+
+            if (isRetriggered()) {
+                stopAudio();
+                break;
+            }
+
+            if (serviceSync() && getSyncShow() == getShowNumber()) {
+                frameCorrection = lockSync(showFrameCount - 1, microsPrev);
+
+                if (syncJumpNeeded()) {
+                    seekShow(getSyncMS());
+                    rendered = openRender(showFrameCount);
+                    playAudio(showFrameCount * SAMPLE_RATE);
+                    microsPrev = micros() - FRAME_US;
+                }
+            }
+
+            // The frame deadline comes first, a command waits for the next gap
+            if (showPaused || (micros() - microsPrev) + COMMAND_SLACK_US < frameUS) {
+                serviceCommands();
+            }
         }
     }
 
-    delay(100);
+    if (showStopped) {
+        stopAudio();
+    }
+
+    closeRender();
+    flushServos();
+    firePendingEvents();
+    beginBlend(0);  // A show stopped mid fade must not leave the fade on the next output
+
+    if (!showStopped) {
+        recordSoakCycle(getShowNumber());
+    }
+}
+
+/**
+*   @brief  Move each newly recorded servo track earlier by the record lag of its servo, the end holds its last value
+*/
+void alignTracks() {
+    uint8_t servoCount = getServoCount();
+
+    for (uint8_t s = 0; s < servoCount; s++) {
+        uint32_t length = trackStart[s + 1] - trackStart[s];
+        uint8_t lag = getLatencyData(s).record;
+
+        // The mouth is baked from the audio, it has nothing to catch up with
+        if (lag == 0 || length < 2 || trackStart[s + 1] > trackLimit || !getServoData(s).enabled || isLipsyncServo(s)) {
+            continue;
+        }
+
+        // Whole samples, rounded, a slow track moves by fewer samples than frames
+        uint32_t shift = min((uint32_t)((lag + (trackDivisor[s] / 2)) / trackDivisor[s]), length - 1);
+        uint8_t* track = program + trackStart[s];
+
+        if (shift > 0) {
+            memmove(track, track + shift, length - shift);
+            memset(track + length - shift, track[length - shift - 1], shift);
+            markDirty(trackStart[s], length);
+        }
+    }
 }
 
 void recordShow() {
     showFrameCount = 0;
     uint8_t servoCount = getServoCount();
 
-    playAudio();
+    resetIO();
+    playAudio(0);
 
     while (showFrameCount < showMaxFrameCount) {
         millisNow = millis();
@@ -193,7 +883,66 @@ void recordShow() {
                 recordServo(s);
             }
 
+            queueServos();
+            recordTelemetry(showFrameCount, servoCount, 0, 0, false);
+
             showFrameCount++;
+        } else {
+            serviceServos();
+            serviceIO();
+            serviceTelemetry();
+        }
+    }
+
+    flushServos();
+    alignTracks();
+}
+
+void jogShow() {
+    Serial.println("Jog show, '+' / '-' 1 frame, '>' / '<' 1 second, 'g' go to ms, 'e' to exit...");
+
+    seekShow(0);
+
+    while (true) {
+        if (Serial.available() > 0) {
+            int32_t frame = showFrameCount;
+
+            switch (Serial.read()) {
+                case '+':
+                    frame++;
+                    break;
+                case '-':
+                    frame--;
+                    break;
+                case '>':
+                    frame += 1000 / SAMPLE_RATE;
+                    break;
+                case '<':
+                    frame -= 1000 / SAMPLE_RATE;
+                    break;
+                case 'g':
+                    Serial.print("Enter show time in milliseconds: ");
+                    frame = getInt() / SAMPLE_RATE;
+                    break;
+                case 'e':
+                    return;
+                default:
+                    continue;
+            }
+
+            frame = constrain(frame, 0, (int32_t)showMaxFrameCount - 1);
+            seekShow(frame * SAMPLE_RATE);
+
+            for (uint8_t s = 0; s < getServoCount(); s++) {
+                playServo(s);
+            }
+
+            flushServos();
+
+            Serial.print("Frame: ");
+            Serial.print(showFrameCount);
+            Serial.print(" | ms: ");
+            Serial.println(showFrameCount * SAMPLE_RATE);
         }
     }
 }
@@ -211,6 +960,8 @@ void testShow() {
             for (uint8_t s = 0; s < servoCount; s++) {
                 updateServo(s);
             }
+
+            flushServos();
         }
     }
 
@@ -220,22 +971,24 @@ void testShow() {
 }
 
 uint8_t getShowNumber() {
-    return program[0xFFE0];
+    return showHeader[SHOW_NUMBER - HEADER_SECTOR];
 }
 
 void setShowNumber(uint8_t number) {
-    program[0xFFE0] = number;
+    showHeader[SHOW_NUMBER - HEADER_SECTOR] = number;
+    markDirty(SHOW_NUMBER, 1);
 }
 
 uint32_t getShowMS() {
-    return (program[0xFFE4] << 24) + (program[0xFFE3] << 16) + (program[0xFFE2] << 8) + program[0xFFE1];
+    return (showHeader[SHOW_MS + 3 - HEADER_SECTOR] << 24) + (showHeader[SHOW_MS + 2 - HEADER_SECTOR] << 16) + (showHeader[SHOW_MS + 1 - HEADER_SECTOR] << 8) + showHeader[SHOW_MS - HEADER_SECTOR];
 }
 
 void setShowMS(uint32_t ms) {
-    program[0xFFE4] = (ms & 0xFF000000UL) >> 24;
-    program[0xFFE3] = (ms & 0x00FF0000UL) >> 16;
-    program[0xFFE2] = (ms & 0x0000FF00UL) >> 8;
-    program[0xFFE1] = (ms & 0x000000FFUL);
+    showHeader[SHOW_MS + 3 - HEADER_SECTOR] = (ms & 0xFF000000UL) >> 24;
+    showHeader[SHOW_MS + 2 - HEADER_SECTOR] = (ms & 0x00FF0000UL) >> 16;
+    showHeader[SHOW_MS + 1 - HEADER_SECTOR] = (ms & 0x0000FF00UL) >> 8;
+    showHeader[SHOW_MS - HEADER_SECTOR] = (ms & 0x000000FFUL);
+    markDirty(SHOW_MS, 4);
 }
 
 char* getShowName() {
@@ -243,8 +996,8 @@ char* getShowName() {
     memset(name, 0, sizeof name);
 
     for (uint8_t c = 0; c < 15; c++) {
-        if (program[0xFFF0 + c] != 0x00) {
-            name[c] = program[0xFFF0 + c];
+        if (showHeader[SHOW_NAME + c - HEADER_SECTOR] != 0x00) {
+            name[c] = showHeader[SHOW_NAME + c - HEADER_SECTOR];
         }
     }
 
@@ -254,21 +1007,102 @@ char* getShowName() {
 void setShowName(char* name) {
     for (uint8_t c = 0; c < 16; c++) {
         if (name[c] != 0x00) {
-            program[0xFFF0 + c] = name[c];
+            showHeader[SHOW_NAME + c - HEADER_SECTOR] = name[c];
         } else {
-        	program[0xFFF0 + c] = 0x00;
+        	showHeader[SHOW_NAME + c - HEADER_SECTOR] = 0x00;
         }
     }
 
+    markDirty(SHOW_NAME, 16);
+
 	saveShow();
 }
 
 void saveData(uint32_t address, uint8_t data) {
-    program[address] = data;
+    if (address < trackLimit) {
+        program[address] = data;
+        markDirty(address, 1);
+    }
 }
 
 uint8_t getData(uint32_t address) {
-    return program[address];
+    return (address < trackLimit) ? program[address] : 0;
+}
+
+const uint8_t* getShowTracks() {
+    return program;
+}
+
+bool isShowUniform() {
+    return tracksUniform;
+}
+
+uint8_t getTrackDivisor(uint8_t number) {
+    return trackDivisor[number];
+}
+
+uint32_t getTrackAddress(uint32_t frame, uint8_t number) {
+    return trackStart[number] + (frame / trackDivisor[number]);
+}
+
+uint32_t getTrackBytes() {
+    return trackStart[getServoCount()];
+}
+
+uint32_t getShowCapacity() {
+    return trackLimit;
+}
+
+bool hasCorruptBlocks() {
+    return blockBadCount > 0;
+}
+
+bool isTrackCorrupt(uint32_t frame, uint8_t number) {
+    // A track past the show data in memory has nothing to play, it holds the same as a corrupt one
+    if (trackStart[number + 1] > trackLimit) {
+        return true;
+    }
+
+    if (blockBadCount == 0) {
+        return false;
+    }
+
+    // The sample and the next one, which it eases towards
+    uint32_t address = getTrackAddress(frame, number);
+    uint32_t next = min(address + 1, trackStart[number + 1] - 1);
+
+    return (blockBad[address / CRC_BLOCK_SIZE / 8] & (1 << ((address / CRC_BLOCK_SIZE) % 8))) ||
+        (blockBad[next / CRC_BLOCK_SIZE / 8] & (1 << ((next / CRC_BLOCK_SIZE) % 8)));
+}
+
+uint8_t getTrackValue(uint32_t frame, uint8_t number) {
+    if (trackStart[number + 1] > trackLimit) {
+        return SHOW_CENTER_VALUE;
+    }
+
+    return readTrack(program + trackStart[number], trackStart[number + 1] - trackStart[number], frame, trackDivisor[number]);
+}
+
+void recordTrack(uint32_t frame, uint8_t number, uint8_t value) {
+    if (frame % trackDivisor[number] == 0) {
+        saveData(getTrackAddress(frame, number), value);
+    }
+}
+
+uint32_t getShowKey() {
+    if (!showKeyValid) {
+        uint32_t trackBytes = min(getTrackBytes(), (uint32_t)SHOW_HEADER);
+
+        showKey = crc32(0, program, min(trackBytes, trackLimit));
+        showKey = crc32(showKey, showHeader + (SHOW_HEADER - HEADER_SECTOR), SHOW_SIZE - SHOW_HEADER);
+
+        if (!tracksUniform) {
+            showKey = crc32(showKey, trackDivisor, sizeof(trackDivisor));
+        }
+        showKeyValid = true;
+    }
+
+    return showKey;
 }
 
 uint32_t getShowFrameCount() {
@@ -6,13 +6,29 @@
 #ifndef SHOW_H_
     #define SHOW_H_
 
+    #include "layout.h"
     #include <Arduino.h>
 
+    #define SHOW_CENTER_VALUE 127  // Middle of the 0 ... 255 range of a track value
+
     /**
     *   @brief  Create a new show file, calls record after the file is created
     */
     void newShow(void);
 
+    /**
+    *   @brief  Find every show file on the SD card with one pass over the directory
+    */
+    void scanShows(void);
+
+    /**
+    *   @brief  Check if a show file was on the SD card at the last scan or has been saved since
+    *
+    *   @param  number  0 ... 255
+    *   @return ```true``` if the show file exists and ```false``` if not
+    */
+    bool showExists(uint8_t number);
+
     /**
     *   @brief  Load a given show file from SD card
     *
@@ -36,6 +52,68 @@
     */
     void playShow(void);
 
+    /**
+    *   @brief  Play the loaded show starting from a given show time, the audio starts at the same time
+    *
+    *   @param  ms  Show time to start from in milliseconds, 0 ... 4294967295
+    */
+    void playShowAt(uint32_t ms);
+
+    /**
+    *   @brief  Get a show ready to start with no delay, seeks the show and render and fills the audio buffer
+    *
+    *   @param  ms  Show time to start from in milliseconds, 0 ... 4294967295
+    */
+    void armShow(uint32_t ms);
+
+    /**
+    *   @brief  Play an armed show from its first frame, audio must be started with startAudio()
+    */
+    void runShow(void);
+
+    /**
+    *   @brief  Stop the playing show at the end of the current frame
+    */
+    void stopShow(void);
+
+    /**
+    *   @brief  Pause or resume the playing show, servos hold their position while paused
+    *
+    *   @param  paused  ```true``` to pause and ```false``` to resume
+    */
+    void pauseShow(bool paused);
+
+    /**
+    *   @brief  Check if the playing show is paused
+    *
+    *   @return ```true``` if paused and ```false``` if not
+    */
+    bool isShowPaused(void);
+
+    /**
+    *   @brief  Check if the last show was stopped before its end
+    *
+    *   @return ```true``` if it was stopped and ```false``` if it played to the end
+    */
+    bool isShowStopped(void);
+
+    /**
+    *   @brief  Prints the position, state and volume of the playing show
+    */
+    void printShowStatus(void);
+
+    /**
+    *   @brief  Move the loaded show to a given show time using the block index
+    *
+    *   @param  ms  Show time in milliseconds, 0 ... 4294967295
+    */
+    void seekShow(uint32_t ms);
+
+    /**
+    *   @brief  Step through the loaded show from the serial port, moving the servos to each frame
+    */
+    void jogShow(void);
+
     /**
     *   @brief  Record show
     */
@@ -96,6 +174,11 @@
     */
     void saveData(uint32_t address, uint8_t data);
 
+    /**
+    *   @brief  Mark the chunks after the show data as changed so the next save rewrites the whole file
+    */
+    void markChunksDirty(void);
+
     /**
     *   @brief  Get data from show file
     *
@@ -104,6 +187,105 @@
     */
     uint8_t getData(uint32_t address);
 
+    /**
+    *   @brief  Get the servo tracks of the loaded show for reading a whole frame at once
+    *
+    *   @return Returns a pointer to the start of the show data
+    */
+    const uint8_t* getShowTracks(void);
+
+    /**
+    *   @brief  Check if every servo track of the loaded show has a sample on every frame
+    *
+    *   @return ```true``` if every rate divisor is 1 and ```false``` if not
+    */
+    bool isShowUniform(void);
+
+    /**
+    *   @brief  Get the rate divisor of a given servo track
+    *
+    *   @param  number  Servo number, 0 ... 63
+    *   @return Returns the number of show frames per stored sample, 1 ... 255
+    */
+    uint8_t getTrackDivisor(uint8_t number);
+
+    /**
+    *   @brief  Get the show address of the sample at or before a frame of a given servo track
+    *
+    *   Tracks are stored one after another, each one only as long as its rate divisor needs
+    *
+    *   @param  frame   Frame number, 0x0000 ... 0xFFE0
+    *   @param  number  Servo number, 0 ... 63
+    *   @return Returns the address of the sample
+    */
+    uint32_t getTrackAddress(uint32_t frame, uint8_t number);
+
+    /**
+    *   @brief  Get the size of the servo tracks of the loaded show
+    *
+    *   @return Returns the number of bytes used by the enabled servos' tracks
+    */
+    uint32_t getTrackBytes(void);
+
+    /**
+    *   @brief  Get the amount of servo track data held in memory
+    *
+    *   @return Returns the number of bytes of tracks that can be read and written, 0 ... 0xFFE0
+    */
+    uint32_t getShowCapacity(void);
+
+    /**
+    *   @brief  Grow the show data in memory to hold the tracks of every configured servo
+    *
+    *   The tracks already in memory are kept, the ones that come in are read from the card or start at 0 on a new show
+    *
+    *   @return ```true``` if every track is in memory and ```false``` if there is not enough memory, nothing changes then
+    */
+    bool growShow(void);
+
+    /**
+    *   @brief  Check if any block of the loaded show did not match its CRC
+    *
+    *   @return ```true``` if a block is corrupt and ```false``` if not or the show has no CRCs
+    */
+    bool hasCorruptBlocks(void);
+
+    /**
+    *   @brief  Check if the samples of a given servo track at a frame are in a corrupt block or not in memory
+    *
+    *   @param  frame   Frame number, 0x0000 ... 0xFFE0
+    *   @param  number  Servo number, 0 ... 63
+    *   @return ```true``` if the servo should hold its last pose and ```false``` if the track can be played
+    */
+    bool isTrackCorrupt(uint32_t frame, uint8_t number);
+
+    /**
+    *   @brief  Get the value of a given servo track at a frame, resampled to the frame rate
+    *
+    *   Check isTrackCorrupt() first, a track that is not in memory reads as the middle of the range
+    *
+    *   @param  frame   Frame number, 0x0000 ... 0xFFE0
+    *   @param  number  Servo number, 0 ... 63
+    *   @return Returns the value interpolated between the stored samples, 0 ... 255
+    */
+    uint8_t getTrackValue(uint32_t frame, uint8_t number);
+
+    /**
+    *   @brief  Save a recorded value to a given servo track, only frames that land on a stored sample are kept
+    *
+    *   @param  frame   Frame number, 0x0000 ... 0xFFE0
+    *   @param  number  Servo number, 0 ... 63
+    *   @param  value   Value to save, 0 ... 255
+    */
+    void recordTrack(uint32_t frame, uint8_t number, uint8_t value);
+
+    /**
+    *   @brief  Get the key of the loaded show data
+    *
+    *   @return Returns the CRC-32 of the servo tracks and header
+    */
+    uint32_t getShowKey(void);
+
     /**
     *   @brief  Get the current show frame
     *
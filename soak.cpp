@@ -0,0 +1,203 @@
+/**
+*   @file   soak.cpp
+*   @brief  Functions for tracking show cycles over long runs and flagging metrics that drift from their baseline
+*
+*   The first cycles after power up set a baseline for each metric. Every later cycle is
+*   folded into a recent average, so a slow drift over a day of auto-play shows up as the
+*   recent average moving away from the baseline instead of being lost in one long max.
+*/
+
+#include "soak.h"
+#include "audio.h"
+#include "memory.h"
+#include "timing.h"
+
+/**
+*   @brief  Struct for the metrics of one show cycle
+*/
+struct cycle_t {
+    uint8_t show;
+    uint8_t valid;  // Bit per metric, gaps and loads are not measured on every cycle
+    int32_t value[SOAK_METRICS];
+};
+
+const char* soakNames[SOAK_METRICS] = {"Load us", "Frames late", "Audio offset us", "Gap us", "Free heap"};
+const int32_t soakSlack[SOAK_METRICS] = {2000, 2, 1000, 5000, 4096};  // Drift below this is never a regression
+
+cycle_t soakHistory[SOAK_HISTORY];
+uint32_t soakCycles = 0;
+uint32_t soakLoadUS = 0;
+uint32_t soakEndUS = 0;
+int64_t soakBaselineSum[SOAK_METRICS] = {};
+uint16_t soakBaselineCount[SOAK_METRICS] = {};
+int32_t soakBaseline[SOAK_METRICS] = {};
+int32_t soakRecent[SOAK_METRICS] = {};
+int32_t soakWorst[SOAK_METRICS] = {};
+uint8_t soakRegressed = 0;
+uint32_t soakRegressedCycle[SOAK_METRICS] = {};
+
+void recordSoakLoad(uint32_t loadUS) {
+    soakLoadUS = loadUS;
+}
+
+/**
+*   @brief  Get how far a metric has drifted in the bad direction
+*
+*   @param  metric  Metric number, 0 ... SOAK_METRICS - 1
+*   @param  value   Value to compare with the baseline
+*   @return Returns the drift, negative if better than the baseline
+*/
+int32_t getSoakDrift(uint8_t metric, int32_t value) {
+    switch (metric) {
+        case SOAK_HEAP:
+            return soakBaseline[metric] - value;
+            break;
+        case SOAK_OFFSET:
+            return abs(value) - abs(soakBaseline[metric]);
+            break;
+        default:
+            return value - soakBaseline[metric];
+            break;
+    }
+}
+
+/**
+*   @brief  Flag a metric once its recent average drifts past the threshold
+*
+*   @param  metric  Metric number, 0 ... SOAK_METRICS - 1
+*/
+void checkSoak(uint8_t metric) {
+    int32_t drift = getSoakDrift(metric, soakRecent[metric]);
+    int32_t limit = max((int32_t)((abs(soakBaseline[metric]) * SOAK_REGRESS_PERCENT) / 100), soakSlack[metric]);
+
+    if (drift > limit && !(soakRegressed & (1 << metric))) {
+        soakRegressed |= (1 << metric);
+        soakRegressedCycle[metric] = soakCycles;
+
+        Serial.print("Soak regression: ");
+        Serial.print(soakNames[metric]);
+        Serial.print(" | Baseline: ");
+        Serial.print(soakBaseline[metric]);
+        Serial.print(" | Recent: ");
+        Serial.println(soakRecent[metric]);
+    }
+}
+
+void recordSoakCycle(uint8_t number) {
+    cycle_t &c = soakHistory[soakCycles % SOAK_HISTORY];
+    uint32_t firstUS = getFirstFrameUS();
+    uint32_t audioUS = getAudioStartUS();
+    uint32_t freeHeap = getFreeHeap();
+
+    c.show = number;
+    c.valid = (1 << SOAK_OVERRUNS);
+    c.value[SOAK_LOAD] = soakLoadUS;
+    c.value[SOAK_OVERRUNS] = getFrameOverruns();
+    c.value[SOAK_OFFSET] = (int32_t)(audioUS - firstUS);
+    c.value[SOAK_GAP] = firstUS - soakEndUS;
+    c.value[SOAK_HEAP] = freeHeap;
+
+    if (soakLoadUS != 0) {
+        c.valid |= (1 << SOAK_LOAD);
+    }
+
+    if (audioUS != 0 && firstUS != 0) {
+        c.valid |= (1 << SOAK_OFFSET);
+    }
+
+    if (soakEndUS != 0 && firstUS != 0 && (uint32_t)c.value[SOAK_GAP] < SOAK_GAP_MAX_MS * 1000UL) {
+        c.valid |= (1 << SOAK_GAP);
+    }
+
+    if (freeHeap != 0) {
+        c.valid |= (1 << SOAK_HEAP);
+    }
+
+    soakLoadUS = 0;
+    soakEndUS = micros();
+    soakCycles++;
+
+    for (uint8_t m = 0; m < SOAK_METRICS; m++) {
+        if (!(c.valid & (1 << m))) {
+            continue;
+        }
+
+        int32_t value = c.value[m];
+
+        if (soakBaselineCount[m] < SOAK_BASELINE_CYCLES) {
+            soakBaselineSum[m] += value;
+            soakBaselineCount[m]++;
+            soakBaseline[m] = soakBaselineSum[m] / soakBaselineCount[m];
+            soakRecent[m] = soakBaseline[m];
+            soakWorst[m] = (soakBaselineCount[m] == 1) ? value : soakWorst[m];
+            continue;
+        }
+
+        // Recent average over roughly the last 8 cycles
+        soakRecent[m] += (value - soakRecent[m]) / 8;
+
+        if (getSoakDrift(m, value) > getSoakDrift(m, soakWorst[m])) {
+            soakWorst[m] = value;
+        }
+
+        checkSoak(m);
+    }
+}
+
+bool isSoakRegressed() {
+    return soakRegressed != 0;
+}
+
+void printSoak() {
+    if (soakCycles == 0) {
+        return;
+    }
+
+    Serial.println("\n---- Soak Report ----");
+    Serial.print("Cycles: ");
+    Serial.print(soakCycles);
+    Serial.print(" | Up minutes: ");
+    Serial.print(millis() / 60000);
+    Serial.print(" | ");
+    Serial.println(isSoakRegressed() ? "REGRESSED" : "OK");
+
+    for (uint8_t m = 0; m < SOAK_METRICS; m++) {
+        if (soakBaselineCount[m] == 0) {
+            continue;
+        }
+
+        Serial.print(soakNames[m]);
+        Serial.print(": baseline ");
+        Serial.print(soakBaseline[m]);
+        Serial.print(" | recent ");
+        Serial.print(soakRecent[m]);
+        Serial.print(" | worst ");
+        Serial.print(soakWorst[m]);
+
+        if (soakRegressed & (1 << m)) {
+            Serial.print(" | Regressed at cycle ");
+            Serial.print(soakRegressedCycle[m]);
+        }
+
+        Serial.println();
+    }
+
+    Serial.println("Last cycles, show: load us, late, offset us, gap us, heap");
+
+    for (uint8_t i = min(soakCycles, (uint32_t)SOAK_HISTORY); i > 0; i--) {
+        const cycle_t &c = soakHistory[(soakCycles - i) % SOAK_HISTORY];
+
+        Serial.print(c.show);
+        Serial.print(": ");
+
+        for (uint8_t m = 0; m < SOAK_METRICS; m++) {
+            if (c.valid & (1 << m)) {
+                Serial.print(c.value[m]);
+            } else {
+                Serial.print("-");
+            }
+
+            Serial.print((m < SOAK_METRICS - 1) ? ", " : "\n");
+        }
+    }
+}
@@ -0,0 +1,51 @@
+/**
+*   @file   soak.h
+*   @brief  Functions for tracking show cycles over long runs and flagging metrics that drift from their baseline
+*/
+
+#ifndef SOAK_H_
+    #define SOAK_H_
+
+    #include <Arduino.h>
+
+    #define SOAK_BASELINE_CYCLES 16  // Cycles averaged into the baseline after power up
+    #define SOAK_HISTORY 8  // Last cycles kept for the report
+    #define SOAK_REGRESS_PERCENT 50  // A metric this far over its baseline is a regression
+    #define SOAK_GAP_MAX_MS 10000  // Longer gaps are waits for a trigger, the hours or the menu, not a cycle
+
+    #define SOAK_LOAD 0
+    #define SOAK_OVERRUNS 1
+    #define SOAK_OFFSET 2
+    #define SOAK_GAP 3
+    #define SOAK_HEAP 4
+    #define SOAK_METRICS 5
+
+    /**
+    *   @brief  Record the time taken to load a show, kept for the next show cycle
+    *
+    *   @param  loadUS  Microseconds from opening the show file to the show being ready, 0 ... 4294967295
+    */
+    void recordSoakLoad(uint32_t loadUS);
+
+    /**
+    *   @brief  Record the end of a show cycle and check every metric against its baseline
+    *
+    *   Uses the timing of the show that just ended, call once after the last frame
+    *
+    *   @param  number  Show number, 0 ... 255
+    */
+    void recordSoakCycle(uint8_t number);
+
+    /**
+    *   @brief  Check if any metric has regressed past its threshold since power up
+    *
+    *   @return ```true``` if a metric regressed and ```false``` if not
+    */
+    bool isSoakRegressed(void);
+
+    /**
+    *   @brief  Prints the cycle count, baselines, recent averages and the last cycles
+    */
+    void printSoak(void);
+
+#endif  // SOAK_H_
@@ -0,0 +1,153 @@
+/**
+*   @file   storage.cpp
+*   @brief  Functions for crash-safe, sector aligned writes to the SD card
+*
+*   A save is written to "NAME.EX~", renamed to "NAME.EX!" once it has been synced
+*   and then renamed over the original. A "~" file is always incomplete and a "!"
+*   file is always complete, so recoverSave() knows which one to keep after a power loss.
+*/
+
+#include "storage.h"
+#include "sdio.h"
+#include <SD.h>
+
+File SAVE_FILE;
+char saveName[13] = "";
+char tempName[13] = "";
+char doneName[13] = "";
+uint8_t sector[SECTOR_SIZE] = {};
+uint16_t sectorFill = 0;
+
+void setSaveNames(const char* fileName) {
+    // commitSave() passes saveName itself, and snprintf() must not copy a buffer onto itself
+    if (fileName != saveName) {
+        snprintf(saveName, sizeof(saveName), "%s", fileName);
+    }
+
+    snprintf(tempName, sizeof(tempName), "%s", saveName);
+    snprintf(doneName, sizeof(doneName), "%s", saveName);
+
+    tempName[strlen(tempName) - 1] = '~';
+    doneName[strlen(doneName) - 1] = '!';
+}
+
+bool beginSave(const char* fileName) {
+    setSaveNames(fileName);
+    sectorFill = 0;
+
+    if (SD.exists(tempName)) {
+        SD.remove(tempName);
+    }
+
+    SAVE_FILE = SD.open(tempName, FILE_WRITE_BEGIN);
+
+    if (!SAVE_FILE) {
+        Serial.print("Error opening: ");
+        Serial.println(tempName);
+        return false;
+    }
+
+    return true;
+}
+
+bool writeSave(const uint8_t* data, uint32_t size) {
+    while (size > 0) {
+        uint16_t count = min(size, (uint32_t)(SECTOR_SIZE - sectorFill));
+        memcpy(sector + sectorFill, data, count);
+        sectorFill += count;
+        data += count;
+        size -= count;
+
+        if (sectorFill == SECTOR_SIZE) {
+            if (writeBlocks(SAVE_FILE, sector, SECTOR_SIZE) != SECTOR_SIZE) {
+                Serial.print("Error writing: ");
+                Serial.println(tempName);
+                return false;
+            }
+
+            sectorFill = 0;
+        }
+    }
+
+    return true;
+}
+
+bool writeChunkHeader(const char* tag, uint32_t size) {
+    uint8_t header[8] = {(uint8_t)tag[0], (uint8_t)tag[1], (uint8_t)tag[2], (uint8_t)tag[3],
+        (uint8_t)(size & 0xFF), (uint8_t)((size >> 8) & 0xFF), (uint8_t)((size >> 16) & 0xFF), (uint8_t)(size >> 24)};
+
+    return writeSave(header, sizeof(header));
+}
+
+bool commitSave() {
+    if (sectorFill > 0) {
+        if (writeBlocks(SAVE_FILE, sector, sectorFill) != sectorFill) {
+            Serial.print("Error writing: ");
+            Serial.println(tempName);
+            abortSave();
+            return false;
+        }
+
+        sectorFill = 0;
+    }
+
+    SAVE_FILE.flush();
+    SAVE_FILE.close();
+
+    if (SD.exists(doneName)) {
+        SD.remove(doneName);
+    }
+
+    if (!SD.rename(tempName, doneName)) {
+        Serial.print("Error renaming: ");
+        Serial.println(tempName);
+        return false;
+    }
+
+    recoverSave(saveName);
+
+    return true;
+}
+
+void abortSave() {
+    SAVE_FILE.close();
+    SD.remove(tempName);
+    sectorFill = 0;
+}
+
+bool writeInPlace(const char* fileName, uint32_t address, const uint8_t* data, uint32_t size) {
+    File file = SD.open(fileName, FILE_WRITE_BEGIN);
+
+    if (!file) {
+        Serial.print("Error opening: ");
+        Serial.println(fileName);
+        return false;
+    }
+
+    bool written = file.seek(address) && (file.write(data, size) == size);
+    file.flush();
+    file.close();
+
+    if (!written) {
+        Serial.print("Error writing: ");
+        Serial.println(fileName);
+    }
+
+    return written;
+}
+
+void recoverSave(const char* fileName) {
+    setSaveNames(fileName);
+
+    if (SD.exists(tempName)) {
+        SD.remove(tempName);
+    }
+
+    if (SD.exists(doneName)) {
+        if (SD.exists(saveName)) {
+            SD.remove(saveName);
+        }
+
+        SD.rename(doneName, saveName);
+    }
+}
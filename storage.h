@@ -0,0 +1,69 @@
+/**
+*   @file   storage.h
+*   @brief  Functions for crash-safe, sector aligned writes to the SD card
+*/
+
+#ifndef STORAGE_H_
+    #define STORAGE_H_
+
+    #include <Arduino.h>
+
+    #define SECTOR_SIZE 512
+
+    /**
+    *   @brief  Start a crash-safe save, data is written to a temp file until commitSave() is called
+    *
+    *   @param  fileName    8.3 file name to save, e.g. "000.ANI"
+    *   @return ```true``` if the temp file was opened and ```false``` if there was an error
+    */
+    bool beginSave(const char* fileName);
+
+    /**
+    *   @brief  Write data to the open save, data is buffered and written to the card in whole sectors
+    *
+    *   @param  data    Data to write
+    *   @param  size    Number of bytes to write
+    *   @return ```true``` if the data was written and ```false``` if there was an error
+    */
+    bool writeSave(const uint8_t* data, uint32_t size);
+
+    /**
+    *   @brief  Write a chunk header to the open save, the chunk data must follow
+    *
+    *   @param  tag     4 character chunk tag, e.g. "EVNT"
+    *   @param  size    Size of the chunk data in bytes
+    *   @return ```true``` if the header was written and ```false``` if there was an error
+    */
+    bool writeChunkHeader(const char* tag, uint32_t size);
+
+    /**
+    *   @brief  Flush, sync and rename the temp file over the original file
+    *
+    *   @return ```true``` if the file was saved and ```false``` if there was an error
+    */
+    bool commitSave(void);
+
+    /**
+    *   @brief  Abandon the open save, the original file is left untouched
+    */
+    void abortSave(void);
+
+    /**
+    *   @brief  Overwrite part of an existing file without rewriting the rest of it
+    *
+    *   @param  fileName    8.3 file name to write to
+    *   @param  address     Offset in the file to start writing at, should be sector aligned
+    *   @param  data        Data to write
+    *   @param  size        Number of bytes to write, should be a whole number of sectors
+    *   @return ```true``` if the data was written and ```false``` if there was an error
+    */
+    bool writeInPlace(const char* fileName, uint32_t address, const uint8_t* data, uint32_t size);
+
+    /**
+    *   @brief  Finish or clean up a save that was interrupted by a power loss
+    *
+    *   @param  fileName    8.3 file name to recover
+    */
+    void recoverSave(const char* fileName);
+
+#endif  // STORAGE_H_
@@ -0,0 +1,158 @@
+/**
+*   @file   sync.cpp
+*   @brief  Functions for keeping several controllers in step with a serial timecode
+*
+*   The master sends a 7 byte timecode on Serial1 (an RS-485 transceiver for runs between
+*   figures) at the start of every 10th frame: 0xA5, show, frame (uint32 little endian), xor.
+*   Followers measure their offset to it and lengthen or shorten their frame period by
+*   at most SYNC_MAX_SLEW_US until the offset is gone.
+*/
+
+#include "sync.h"
+#include "config.h"
+#include "show.h"
+
+#define SYNC_SERIAL Serial1
+#define SYNC_BAUD 115200
+#define SYNC_START 0xA5
+#define SYNC_PACKET_SIZE 7
+#define SYNC_INTERVAL_FRAMES 10
+#define SYNC_WIRE_US ((SYNC_PACKET_SIZE * 10 * 1000000UL) / SYNC_BAUD)  // Time on the wire, 10 bits per byte
+#define SYNC_MAX_SLEW_US (SAMPLE_RATE * 20)  // 2% of a frame
+#define SYNC_JUMP_US 500000  // Offsets larger than this seek instead of slewing
+
+uint8_t syncRole = SYNC_OFF;
+uint8_t packet[SYNC_PACKET_SIZE];
+uint8_t packetFill = 0;
+uint8_t syncShow = 0;
+uint32_t syncFrame = 0;
+uint32_t syncMicros = 0;
+bool syncJump = false;
+uint32_t syncPackets = 0;
+uint32_t syncBadPackets = 0;
+uint32_t syncJumps = 0;
+int32_t syncOffset = 0;
+int32_t syncOffsetMax = 0;
+
+void setupSync() {
+    syncRole = getSyncConfig();
+
+    if (syncRole != SYNC_OFF) {
+        SYNC_SERIAL.begin(SYNC_BAUD);
+    }
+}
+
+uint8_t getSyncRole() {
+    return syncRole;
+}
+
+void sendSync(uint8_t show, uint32_t frame) {
+    if (syncRole != SYNC_MASTER || (frame % SYNC_INTERVAL_FRAMES) != 0) {
+        return;
+    }
+
+    uint8_t data[SYNC_PACKET_SIZE] = {SYNC_START, show,
+        (uint8_t)(frame & 0xFF), (uint8_t)((frame >> 8) & 0xFF), (uint8_t)((frame >> 16) & 0xFF), (uint8_t)(frame >> 24), 0};
+
+    for (uint8_t b = 0; b < SYNC_PACKET_SIZE - 1; b++) {
+        data[SYNC_PACKET_SIZE - 1] ^= data[b];
+    }
+
+    SYNC_SERIAL.write(data, SYNC_PACKET_SIZE);
+}
+
+bool serviceSync() {
+    if (syncRole != SYNC_FOLLOWER) {
+        return false;
+    }
+
+    while (SYNC_SERIAL.available() > 0) {
+        uint8_t value = SYNC_SERIAL.read();
+
+        if (packetFill == 0 && value != SYNC_START) {
+            continue;
+        }
+
+        packet[packetFill++] = value;
+
+        if (packetFill == SYNC_PACKET_SIZE) {
+            uint8_t check = 0;
+            packetFill = 0;
+
+            for (uint8_t b = 0; b < SYNC_PACKET_SIZE; b++) {
+                check ^= packet[b];
+            }
+
+            if (check != 0) {
+                syncBadPackets++;
+                continue;
+            }
+
+            syncShow = packet[1];
+            syncFrame = (packet[5] << 24) + (packet[4] << 16) + (packet[3] << 8) + packet[2];
+            syncMicros = micros() - SYNC_WIRE_US;
+            syncPackets++;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint8_t getSyncShow() {
+    return syncShow;
+}
+
+uint32_t getSyncMS() {
+    return (syncFrame * SAMPLE_RATE) + ((micros() - syncMicros) / 1000);
+}
+
+int32_t lockSync(uint32_t lastFrame, uint32_t lastFrameUS) {
+    // Where the local show was when the master started syncFrame, both in microseconds of show time
+    int32_t localUS = ((int32_t)lastFrame * SAMPLE_RATE * 1000) + (int32_t)(syncMicros - lastFrameUS);
+    int32_t masterUS = (int32_t)syncFrame * SAMPLE_RATE * 1000;
+
+    syncOffset = masterUS - localUS;
+    syncOffsetMax = max(syncOffsetMax, abs(syncOffset));
+    syncJump = abs(syncOffset) > SYNC_JUMP_US;
+
+    if (syncJump) {
+        syncJumps++;
+        return 0;
+    }
+
+    // Remove the offset over the frames until the next timecode, master ahead shortens the frame
+    return constrain(-syncOffset / SYNC_INTERVAL_FRAMES, -SYNC_MAX_SLEW_US, SYNC_MAX_SLEW_US);
+}
+
+bool syncJumpNeeded() {
+    return syncJump;
+}
+
+void resetSync() {
+    syncPackets = 0;
+    syncBadPackets = 0;
+    syncJumps = 0;
+    syncOffset = 0;
+    syncOffsetMax = 0;
+    syncJump = false;
+}
+
+void printSync() {
+    if (syncRole != SYNC_FOLLOWER) {
+        return;
+    }
+
+    Serial.println("\n---- Sync Report ----");
+    Serial.print("Timecodes: ");
+    Serial.print(syncPackets);
+    Serial.print(" | Bad: ");
+    Serial.print(syncBadPackets);
+    Serial.print(" | Jumps: ");
+    Serial.println(syncJumps);
+    Serial.print("Offset to master us last: ");
+    Serial.print(syncOffset);
+    Serial.print(" | max: ");
+    Serial.println(syncOffsetMax);
+}
@@ -0,0 +1,82 @@
+/**
+*   @file   sync.h
+*   @brief  Functions for keeping several controllers in step with a serial timecode
+*/
+
+#ifndef SYNC_H_
+    #define SYNC_H_
+
+    #include <Arduino.h>
+
+    #define SYNC_OFF 0
+    #define SYNC_MASTER 1
+    #define SYNC_FOLLOWER 2
+
+    /**
+    *   @brief  Setup the timecode port from the config file
+    */
+    void setupSync(void);
+
+    /**
+    *   @brief  Get the timecode role of this controller
+    *
+    *   @return Returns SYNC_OFF, SYNC_MASTER or SYNC_FOLLOWER
+    */
+    uint8_t getSyncRole(void);
+
+    /**
+    *   @brief  Send the timecode for a frame, only sends on a master and every few frames
+    *
+    *   @param  show    Show number, 0 ... 255
+    *   @param  frame   Frame that has just started, 0x0000 ... 0xFFE0
+    */
+    void sendSync(uint8_t show, uint32_t frame);
+
+    /**
+    *   @brief  Read timecode bytes from the timecode port
+    *
+    *   @return ```true``` if a complete timecode has arrived and ```false``` if not
+    */
+    bool serviceSync(void);
+
+    /**
+    *   @brief  Get the show number from the last timecode
+    *
+    *   @return Returns the master show number, 0 ... 255
+    */
+    uint8_t getSyncShow(void);
+
+    /**
+    *   @brief  Get the master show time at the moment the last timecode was received
+    *
+    *   @return Returns the master show time in milliseconds, 0 ... 4294967295
+    */
+    uint32_t getSyncMS(void);
+
+    /**
+    *   @brief  Compare the last timecode to the local frame clock and get the frame period correction
+    *
+    *   @param  lastFrame       Local frame that was last output, 0x0000 ... 0xFFE0
+    *   @param  lastFrameUS     micros() when the last frame was output
+    *   @return Returns the microseconds to add to the next frame periods, limited to the max slew
+    */
+    int32_t lockSync(uint32_t lastFrame, uint32_t lastFrameUS);
+
+    /**
+    *   @brief  Check if the last offset was too large to slew and the show should seek instead
+    *
+    *   @return ```true``` if the follower should seek to getSyncMS() and ```false``` if not
+    */
+    bool syncJumpNeeded(void);
+
+    /**
+    *   @brief  Reset the timecode counters, called at the start of each show
+    */
+    void resetSync(void);
+
+    /**
+    *   @brief  Prints the measured offset to the master for the last show
+    */
+    void printSync(void);
+
+#endif  // SYNC_H_
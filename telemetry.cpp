@@ -0,0 +1,146 @@
+/**
+*   @file   telemetry.cpp
+*   @brief  Functions for streaming live servo positions and frame timing over USB serial
+*
+*   Each frame packet is: 0xA7, 0x7E, type, length (uint16), frame (uint32), late us (uint16),
+*   compute us (uint16), servo count, then per servo ticks (uint16), input value and filtered
+*   value, then the xor of every byte after the sync bytes. Everything is little endian.
+*   Frames played from the render cache have their own type and send 0 for both values.
+*   tools/telemetry.cpp decodes the stream to CSV on a PC.
+*/
+
+#include "telemetry.h"
+#include "servo.h"
+
+#define TELEMETRY_RING_SIZE 4096  // Power of 2
+#define TELEMETRY_RING_MASK (TELEMETRY_RING_SIZE - 1)
+#define TELEMETRY_HEADER_SIZE 14
+#define TELEMETRY_SERVO_SIZE 4
+
+uint8_t telemetryRing[TELEMETRY_RING_SIZE];
+volatile uint32_t telemetryHead = 0;  // Written by the frame loop
+volatile uint32_t telemetryTail = 0;  // Written by serviceTelemetry()
+bool telemetryEnabled = false;
+uint32_t telemetryFrames = 0;
+uint32_t telemetryDropped = 0;
+uint32_t telemetryUSMax = 0;
+uint64_t telemetryUSTotal = 0;
+
+void setTelemetry(bool enabled) {
+    telemetryEnabled = enabled;
+
+    if (enabled) {
+        telemetryHead = 0;
+        telemetryTail = 0;
+        telemetryFrames = 0;
+        telemetryDropped = 0;
+        telemetryUSMax = 0;
+        telemetryUSTotal = 0;
+    }
+}
+
+bool isTelemetryEnabled() {
+    return telemetryEnabled;
+}
+
+void recordTelemetry(uint32_t frame, uint8_t servoCount, uint32_t lateUS, uint32_t computeUS, bool rendered) {
+    if (!telemetryEnabled) {
+        return;
+    }
+
+    uint32_t startUS = micros();
+    uint16_t length = TELEMETRY_HEADER_SIZE + (servoCount * TELEMETRY_SERVO_SIZE) + 1;
+    uint32_t head = telemetryHead;
+
+    if (TELEMETRY_RING_SIZE - (head - telemetryTail) < length) {
+        // The host is not keeping up, drop the frame rather than wait for it
+        telemetryDropped++;
+        return;
+    }
+
+    uint8_t header[TELEMETRY_HEADER_SIZE] = {TELEMETRY_SYNC_0, TELEMETRY_SYNC_1,
+        (uint8_t)(rendered ? TELEMETRY_FRAME_RENDERED : TELEMETRY_FRAME),
+        (uint8_t)(length & 0xFF), (uint8_t)(length >> 8),
+        (uint8_t)(frame & 0xFF), (uint8_t)((frame >> 8) & 0xFF), (uint8_t)((frame >> 16) & 0xFF), (uint8_t)(frame >> 24),
+        (uint8_t)(min(lateUS, 0xFFFFUL) & 0xFF), (uint8_t)(min(lateUS, 0xFFFFUL) >> 8),
+        (uint8_t)(min(computeUS, 0xFFFFUL) & 0xFF), (uint8_t)(min(computeUS, 0xFFFFUL) >> 8),
+        servoCount};
+    uint8_t check = 0;
+
+    for (uint8_t b = 0; b < TELEMETRY_HEADER_SIZE; b++) {
+        telemetryRing[head++ & TELEMETRY_RING_MASK] = header[b];
+        check ^= (b >= 2) ? header[b] : 0;
+    }
+
+    for (uint8_t s = 0; s < servoCount; s++) {
+        uint8_t data[TELEMETRY_SERVO_SIZE];
+        uint16_t ticks;
+
+        getServoTelemetry(s, &ticks, &data[2], &data[3]);
+
+        // A rendered frame skips the filter, the value and filtered bytes are left from the last computed frame
+        if (rendered) {
+            data[2] = 0;
+            data[3] = 0;
+        }
+
+        data[0] = ticks & 0xFF;
+        data[1] = ticks >> 8;
+
+        for (uint8_t b = 0; b < TELEMETRY_SERVO_SIZE; b++) {
+            telemetryRing[head++ & TELEMETRY_RING_MASK] = data[b];
+            check ^= data[b];
+        }
+    }
+
+    telemetryRing[head++ & TELEMETRY_RING_MASK] = check;
+
+    // Publish the whole packet at once
+    telemetryHead = head;
+    telemetryFrames++;
+
+    uint32_t elapsedUS = micros() - startUS;
+    telemetryUSMax = max(telemetryUSMax, elapsedUS);
+    telemetryUSTotal += elapsedUS;
+}
+
+void serviceTelemetry() {
+    uint32_t tail = telemetryTail;
+    uint32_t available = telemetryHead - tail;
+
+    if (available == 0) {
+        return;
+    }
+
+    int space = Serial.availableForWrite();
+
+    if (space <= 0) {
+        return;
+    }
+
+    // Never more than fits, so the write never waits for the host
+    uint32_t contiguous = TELEMETRY_RING_SIZE - (tail & TELEMETRY_RING_MASK);
+    uint32_t count = min(min(available, contiguous), (uint32_t)space);
+
+    Serial.write(&telemetryRing[tail & TELEMETRY_RING_MASK], count);
+    telemetryTail = tail + count;
+}
+
+void printTelemetry() {
+    if (telemetryFrames == 0 && telemetryDropped == 0) {
+        return;
+    }
+
+    Serial.println("\n---- Telemetry Report ----");
+    Serial.print("Frames sent: ");
+    Serial.print(telemetryFrames);
+    Serial.print(" | Dropped: ");
+    Serial.println(telemetryDropped);
+
+    if (telemetryFrames > 0) {
+        Serial.print("Overhead per frame us avg: ");
+        Serial.print((uint32_t)(telemetryUSTotal / telemetryFrames));
+        Serial.print(" | max: ");
+        Serial.println(telemetryUSMax);
+    }
+}
@@ -0,0 +1,51 @@
+/**
+*   @file   telemetry.h
+*   @brief  Functions for streaming live servo positions and frame timing over USB serial
+*/
+
+#ifndef TELEMETRY_H_
+    #define TELEMETRY_H_
+
+    #include <Arduino.h>
+
+    #define TELEMETRY_SYNC_0 0xA7
+    #define TELEMETRY_SYNC_1 0x7E
+    #define TELEMETRY_FRAME 0x01
+    #define TELEMETRY_FRAME_RENDERED 0x02  // Played from the render cache, the value and filtered bytes are not live
+
+    /**
+    *   @brief  Turn the telemetry stream on or off
+    *
+    *   @param  enabled ```true``` to stream and ```false``` to stop
+    */
+    void setTelemetry(bool enabled);
+
+    /**
+    *   @brief  Check if the telemetry stream is on
+    *
+    *   @return ```true``` if streaming and ```false``` if not
+    */
+    bool isTelemetryEnabled(void);
+
+    /**
+    *   @brief  Copy a frame of servo positions and timing into the telemetry ring, dropped if the ring is full
+    *
+    *   @param  frame       Frame number, 0x0000 ... 0xFFE0
+    *   @param  servoCount  Number of servos, 0 ... 63
+    *   @param  lateUS      Microseconds the frame started after its deadline, 0 ... 4294967295
+    *   @param  computeUS   Microseconds spent computing and queueing the frame, 0 ... 4294967295
+    *   @param  rendered    ```true``` if the frame came from the render cache, only its ticks are live
+    */
+    void recordTelemetry(uint32_t frame, uint8_t servoCount, uint32_t lateUS, uint32_t computeUS, bool rendered);
+
+    /**
+    *   @brief  Write as much of the telemetry ring as the USB serial buffer takes without blocking
+    */
+    void serviceTelemetry(void);
+
+    /**
+    *   @brief  Prints the telemetry counters and the time it adds to each frame
+    */
+    void printTelemetry(void);
+
+#endif  // TELEMETRY_H_
@@ -0,0 +1,208 @@
+/**
+*   @file   timing.cpp
+*   @brief  Functions for measuring and reporting show timing
+*/
+
+#include "timing.h"
+
+uint32_t frameCount = 0;
+uint32_t frameOverruns = 0;
+uint32_t frameLateMax = 0;
+uint32_t frameComputeMax = 0;
+uint32_t outputOverlaps = 0;
+uint32_t eventsFired = 0;
+uint32_t eventLatencyMax = 0;
+uint64_t eventLatencyTotal = 0;
+uint32_t firstFrameUS = 0;
+uint32_t saturatedFrames = 0;
+uint32_t saturatedMax = 0;
+uint32_t saturatedFirst = 0;
+uint32_t saturatedLast = 0;
+uint8_t corruptBlocks = 0;
+uint32_t heldServos = 0;
+uint32_t triggerCount = 0;
+uint32_t triggerMotionUS = 0;
+uint32_t triggerMotionMax = 0;
+uint32_t triggerAudioUS = 0;
+uint32_t triggerAudioMax = 0;
+
+#define BOOT_PHASES 12
+
+/**
+*   @brief  Struct for one timestamped startup phase
+*/
+struct bootPhase_t {
+    const char* name;
+    uint32_t us;
+};
+
+bootPhase_t bootPhases[BOOT_PHASES];
+uint8_t bootPhaseCount = 0;
+uint32_t bootMotionUS = 0;
+
+void resetTiming() {
+    frameCount = 0;
+    frameOverruns = 0;
+    frameLateMax = 0;
+    frameComputeMax = 0;
+    outputOverlaps = 0;
+    eventsFired = 0;
+    eventLatencyMax = 0;
+    eventLatencyTotal = 0;
+    firstFrameUS = 0;
+    saturatedFrames = 0;
+    saturatedMax = 0;
+    heldServos = 0;
+}
+
+void recordFrameTiming(uint32_t lateUS, uint32_t computeUS) {
+    if (frameCount == 0) {
+        firstFrameUS = micros();
+    }
+
+    frameCount++;
+
+    if (lateUS >= 1000) {
+        frameOverruns++;
+    }
+
+    frameLateMax = max(frameLateMax, lateUS);
+    frameComputeMax = max(frameComputeMax, computeUS);
+}
+
+void recordEventTiming(uint32_t latencyUS, uint16_t count) {
+    eventsFired += count;
+    eventLatencyTotal += (uint64_t)latencyUS * count;
+    eventLatencyMax = max(eventLatencyMax, latencyUS);
+}
+
+void recordOutputOverlap() {
+    outputOverlaps++;
+}
+
+void recordMotionSaturation(uint32_t frame, uint8_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    if (saturatedFrames == 0) {
+        saturatedFirst = frame;
+    }
+
+    saturatedFrames++;
+    saturatedMax = max(saturatedMax, (uint32_t)count);
+    saturatedLast = frame;
+}
+
+uint32_t getFirstFrameUS() {
+    return firstFrameUS;
+}
+
+uint32_t getFrameOverruns() {
+    return frameOverruns;
+}
+
+void recordCorruptBlocks(uint8_t count) {
+    corruptBlocks = count;
+}
+
+void recordHeldServo() {
+    heldServos++;
+}
+
+void recordTriggerLatency(uint32_t motionUS, uint32_t audioUS) {
+    triggerCount++;
+    triggerMotionUS = motionUS;
+    triggerMotionMax = max(triggerMotionMax, motionUS);
+    triggerAudioUS = audioUS;
+    triggerAudioMax = max(triggerAudioMax, audioUS);
+}
+
+void printTiming() {
+    Serial.println("\n---- Timing Report ----");
+    Serial.print("Frames: ");
+    Serial.println(frameCount);
+    Serial.print("Frames late by 1ms+: ");
+    Serial.print(frameOverruns);
+    Serial.print(" | Max late us: ");
+    Serial.println(frameLateMax);
+    Serial.print("Max frame compute us: ");
+    Serial.println(frameComputeMax);
+    Serial.print("Servo output overlaps: ");
+    Serial.println(outputOverlaps);
+    Serial.print("Events fired: ");
+    Serial.println(eventsFired);
+    Serial.print("Frames over motion limits: ");
+    Serial.print(saturatedFrames);
+
+    if (saturatedFrames > 0) {
+        Serial.print(" | Max servos: ");
+        Serial.print(saturatedMax);
+        Serial.print(" | Frames ");
+        Serial.print(saturatedFirst);
+        Serial.print(" - ");
+        Serial.print(saturatedLast);
+    }
+
+    Serial.println();
+    Serial.print("Corrupt show blocks: ");
+    Serial.print(corruptBlocks);
+    Serial.print(" | Servo frames held: ");
+    Serial.println(heldServos);
+
+    if (eventsFired > 0) {
+        Serial.print("Event latency us avg: ");
+        Serial.print((uint32_t)(eventLatencyTotal / eventsFired));
+        Serial.print(" | max: ");
+        Serial.println(eventLatencyMax);
+    }
+
+    if (triggerCount > 0) {
+        Serial.print("Triggers: ");
+        Serial.println(triggerCount);
+        Serial.print("Trigger to first frame us: ");
+        Serial.print(triggerMotionUS);
+        Serial.print(" | max: ");
+        Serial.println(triggerMotionMax);
+        Serial.print("Trigger to first audio block us: ");
+        Serial.print(triggerAudioUS);
+        Serial.print(" | max: ");
+        Serial.println(triggerAudioMax);
+    }
+}
+
+void markBoot(const char* phase) {
+    if (bootMotionUS == 0 && bootPhaseCount < BOOT_PHASES) {
+        bootPhases[bootPhaseCount].name = phase;
+        bootPhases[bootPhaseCount].us = micros();
+        bootPhaseCount++;
+    }
+}
+
+void markMotion() {
+    if (bootMotionUS == 0) {
+        bootMotionUS = micros();
+    }
+}
+
+void printBoot() {
+    uint32_t usPrev = 0;
+
+    Serial.println("\n---- Boot Report ----");
+
+    for (uint8_t p = 0; p < bootPhaseCount; p++) {
+        Serial.print(bootPhases[p].name);
+        Serial.print(": ");
+        Serial.print(bootPhases[p].us - usPrev);
+        Serial.print("us | At: ");
+        Serial.print(bootPhases[p].us / 1000);
+        Serial.println("ms");
+        usPrev = bootPhases[p].us;
+    }
+
+    if (bootMotionUS != 0) {
+        Serial.print("Power up to first frame: ");
+        Serial.print(bootMotionUS / 1000);
+        Serial.println("ms");
+    }
+}
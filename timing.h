@@ -0,0 +1,101 @@
+/**
+*   @file   timing.h
+*   @brief  Functions for measuring and reporting show timing
+*/
+
+#ifndef TIMING_H_
+    #define TIMING_H_
+
+    #include <Arduino.h>
+
+    /**
+    *   @brief  Reset all timing counters, called at the start of each show
+    */
+    void resetTiming(void);
+
+    /**
+    *   @brief  Record the timing of one show frame
+    *
+    *   @param  lateUS      Microseconds the frame started after its deadline, 0 ... 4294967295
+    *   @param  computeUS   Microseconds spent computing and queueing the frame, 0 ... 4294967295
+    */
+    void recordFrameTiming(uint32_t lateUS, uint32_t computeUS);
+
+    /**
+    *   @brief  Record the latency from the start of a frame to its events firing
+    *
+    *   @param  latencyUS   Microseconds from the start of the frame, 0 ... 4294967295
+    *   @param  count       Number of events fired, 0 ... 65535
+    */
+    void recordEventTiming(uint32_t latencyUS, uint16_t count);
+
+    /**
+    *   @brief  Record a frame that was queued while the previous frame was still being sent
+    */
+    void recordOutputOverlap(void);
+
+    /**
+    *   @brief  Get the time the first frame of the last show was queued
+    *
+    *   @return Returns micros() of the first frame, 0 if no frame has been played
+    */
+    uint32_t getFirstFrameUS(void);
+
+    /**
+    *   @brief  Get the number of frames of the last show that started 1ms or more late
+    *
+    *   @return Returns the number of late frames, 0 ... 4294967295
+    */
+    uint32_t getFrameOverruns(void);
+
+    /**
+    *   @brief  Record how many servos were held back by their motion limits on a frame
+    *
+    *   @param  frame   Show frame number, 0 ... 65503
+    *   @param  count   Number of saturated servos, 0 ... 64
+    */
+    void recordMotionSaturation(uint32_t frame, uint8_t count);
+
+    /**
+    *   @brief  Record the number of show blocks that did not match their CRC, kept until the next show is loaded
+    *
+    *   @param  count   Number of corrupt blocks, 0 ... 128
+    */
+    void recordCorruptBlocks(uint8_t count);
+
+    /**
+    *   @brief  Record a servo that held its last pose on a frame because its track is corrupt
+    */
+    void recordHeldServo(void);
+
+    /**
+    *   @brief  Record the latency from a trigger edge to the show starting, kept across shows
+    *
+    *   @param  motionUS    Microseconds from the edge to the first frame, 0 ... 4294967295
+    *   @param  audioUS     Microseconds from the edge to the first audio block, 0 ... 4294967295
+    */
+    void recordTriggerLatency(uint32_t motionUS, uint32_t audioUS);
+
+    /**
+    *   @brief  Prints the timing report for the last show
+    */
+    void printTiming(void);
+
+    /**
+    *   @brief  Timestamp the end of a startup phase, ignored once the first frame has been sent
+    *
+    *   @param  phase   Name of the phase that just finished
+    */
+    void markBoot(const char* phase);
+
+    /**
+    *   @brief  Timestamp the first show frame sent to the servos after power up, later calls are ignored
+    */
+    void markMotion(void);
+
+    /**
+    *   @brief  Prints the startup phases and the time from power up to the first show frame
+    */
+    void printBoot(void);
+
+#endif  // TIMING_H_
@@ -0,0 +1,727 @@
+/**
+*   @file   anitool.cpp
+*   @brief  Inspects, converts, optimizes and verifies show files on a PC
+*
+*   Build: g++ -std=c++11 -O2 -pthread -o anitool anitool.cpp ../crc.cpp
+*   Use:   ./anitool info|verify|convert|optimize|quantize [options] FILE|DIR...
+*
+*   The show layout and limits come from ../layout.h, the same file the controller is built with.
+*   Files are handed out to worker threads one at a time, each worker reads, checks and
+*   writes whole files, and the reports are printed in file order once all are done.
+*/
+
+#include "../crc.h"
+#include "../layout.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#define MAX_DIVISOR 32  // Largest divisor optimize tries
+
+/**
+*   @brief  Struct for one chunk after the show data
+*/
+struct chunk_t {
+    char tag[5];
+    std::vector<uint8_t> data;
+};
+
+/**
+*   @brief  Struct for a show file read into memory
+*/
+struct show_t {
+    std::vector<uint8_t> image;
+    std::vector<chunk_t> chunks;
+    uint8_t divisor[MAX_SERVOS];
+    uint32_t trackStart[MAX_SERVOS + 1];
+    uint32_t frames;
+    bool truncated;  // A chunk header or chunk ran past the end of the file
+};
+
+/**
+*   @brief  Struct for the command line options
+*/
+struct options_t {
+    std::string command;
+    std::string outDir;
+    int servos = -1;  // -1 counts the tracks that fit
+    int version = -1;
+    int tolerance = 2;
+    int step = 1;
+    int jobs = 0;
+};
+
+options_t options;
+
+uint32_t readLE(const uint8_t* data, uint8_t size) {
+    uint32_t value = 0;
+
+    for (uint8_t b = size; b > 0; b--) {
+        value = (value << 8) + data[b - 1];
+    }
+
+    return value;
+}
+
+void writeLE(std::vector<uint8_t> &out, uint32_t value, uint8_t size) {
+    for (uint8_t b = 0; b < size; b++) {
+        out.push_back((value >> (b * 8)) & 0xFF);
+    }
+}
+
+/**
+*   @brief  Work out where each track starts, the same way the controller does
+*
+*   @param  show    Show to lay out
+*/
+void layoutTracks(show_t &show) {
+    show.frames = readLE(&show.image[SHOW_MS], 4) / SAMPLE_RATE;
+    show.trackStart[0] = 0;
+
+    for (uint8_t n = 0; n < MAX_SERVOS; n++) {
+        show.divisor[n] = std::max(show.divisor[n], (uint8_t)1);
+        show.trackStart[n + 1] = show.trackStart[n] + showTrackLength(show.frames, show.divisor[n]);
+    }
+}
+
+bool isUniform(const show_t &show) {
+    for (uint8_t n = 0; n < MAX_SERVOS; n++) {
+        if (show.divisor[n] != 1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+*   @brief  Get the number of servo tracks to work on
+*
+*   @param  show    Loaded show
+*   @return Returns -n if it was given, otherwise the number of tracks that fit the show data,
+*           check tracksFit() before reading the tracks of a -n count
+*/
+uint8_t getServoCount(const show_t &show) {
+    if (options.servos >= 0) {
+        return options.servos;
+    }
+
+    uint8_t count = 0;
+
+    while (count < MAX_SERVOS && show.frames > 0 && show.trackStart[count + 1] <= SHOW_HEADER) {
+        count++;
+    }
+
+    return count;
+}
+
+/**
+*   @brief  Check that the tracks being worked on end before the show header
+*
+*   @param  show    Loaded show
+*   @return Returns ```true``` if every track is inside the show data and ```false``` if -n asked for more
+*/
+bool tracksFit(const show_t &show) {
+    return show.trackStart[getServoCount(show)] <= SHOW_HEADER;
+}
+
+uint8_t trackValue(const show_t &show, uint32_t frame, uint8_t number) {
+    uint32_t start = show.trackStart[number];
+    return readTrack(&show.image[start], show.trackStart[number + 1] - start, frame, show.divisor[number]);
+}
+
+chunk_t* findChunk(show_t &show, const char* tag) {
+    for (chunk_t &chunk : show.chunks) {
+        if (memcmp(chunk.tag, tag, 4) == 0) {
+            return &chunk;
+        }
+    }
+
+    return NULL;
+}
+
+void removeChunk(show_t &show, const char* tag) {
+    show.chunks.erase(std::remove_if(show.chunks.begin(), show.chunks.end(),
+        [tag](const chunk_t &chunk) { return memcmp(chunk.tag, tag, 4) == 0; }), show.chunks.end());
+}
+
+bool readShow(const std::string &path, show_t &show, std::string &error) {
+    FILE* file = fopen(path.c_str(), "rb");
+
+    if (file == NULL) {
+        error = "can not open";
+        return false;
+    }
+
+    show.image.assign(SHOW_SIZE, 0);
+    show.chunks.clear();
+    show.truncated = false;
+    memset(show.divisor, 1, sizeof(show.divisor));
+
+    if (fread(show.image.data(), 1, SHOW_SIZE, file) != SHOW_SIZE) {
+        fclose(file);
+        error = "shorter than the show data";
+        return false;
+    }
+
+    uint8_t header[CHUNK_HEADER_SIZE];
+    size_t count;
+
+    while ((count = fread(header, 1, CHUNK_HEADER_SIZE, file)) > 0) {
+        chunk_t chunk;
+        memcpy(chunk.tag, header, 4);
+        chunk.tag[4] = 0;
+
+        if (count != CHUNK_HEADER_SIZE) {
+            show.truncated = true;
+            break;
+        }
+
+        chunk.data.resize(readLE(header + 4, 4));
+
+        if (fread(chunk.data.data(), 1, chunk.data.size(), file) != chunk.data.size()) {
+            show.truncated = true;
+            break;
+        }
+
+        show.chunks.push_back(chunk);
+    }
+
+    fclose(file);
+
+    chunk_t* rates = findChunk(show, CHUNK_RATES);
+
+    if (rates != NULL) {
+        memcpy(show.divisor, rates->data.data(), std::min(rates->data.size(), sizeof(show.divisor)));
+    }
+
+    layoutTracks(show);
+
+    return true;
+}
+
+/**
+*   @brief  Write a show to a temp file and rename it over the target, a failed write leaves the target as it was
+*
+*   @param  path    File to write
+*   @param  show    Show to write
+*   @param  error   Returns what went wrong
+*   @return ```true``` if the file was written and ```false``` if not
+*/
+bool writeShow(const std::string &path, const show_t &show, std::string &error) {
+    std::string temp = path + "~";
+    FILE* file = fopen(temp.c_str(), "wb");
+
+    if (file == NULL) {
+        error = "can not create " + temp;
+        return false;
+    }
+
+    std::vector<uint8_t> data(show.image);
+
+    if (show.image[SHOW_VERSION_BYTE] >= 1) {
+        for (const chunk_t &chunk : show.chunks) {
+            data.insert(data.end(), chunk.tag, chunk.tag + 4);
+            writeLE(data, chunk.data.size(), 4);
+            data.insert(data.end(), chunk.data.begin(), chunk.data.end());
+        }
+    }
+
+    bool written = (fwrite(data.data(), 1, data.size(), file) == data.size());
+    written = (fclose(file) == 0) && written;
+
+    if (!written || rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+        error = "can not write " + path;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+*   @brief  Replace the BCRC chunk with the CRC of each block of the show data as it is now
+*
+*   @param  show    Show to stamp
+*/
+void stampCrcs(show_t &show) {
+    chunk_t crcs;
+    memcpy(crcs.tag, CHUNK_CRCS, 5);
+
+    for (uint8_t b = 0; b < CRC_BLOCKS; b++) {
+        writeLE(crcs.data, crc32(0, &show.image[b * CRC_BLOCK_SIZE], crcBlockSize(b)), 4);
+    }
+
+    removeChunk(show, CHUNK_CRCS);
+    show.chunks.push_back(crcs);
+}
+
+/**
+*   @brief  Set the rate divisors of a show and repack its tracks, each track is resampled from the current one
+*
+*   @param  show        Show to repack
+*   @param  divisor     New rate divisor of each servo
+*   @param  servoCount  Number of tracks to keep
+*/
+void repackShow(show_t &show, const uint8_t* divisor, uint8_t servoCount) {
+    show_t packed = show;
+    memcpy(packed.divisor, divisor, sizeof(packed.divisor));
+    layoutTracks(packed);
+    std::fill(packed.image.begin(), packed.image.begin() + SHOW_HEADER, 0);
+
+    for (uint8_t n = 0; n < servoCount; n++) {
+        uint32_t length = packed.trackStart[n + 1] - packed.trackStart[n];
+
+        for (uint32_t i = 0; i < length && packed.trackStart[n] + i < SHOW_HEADER; i++) {
+            packed.image[packed.trackStart[n] + i] = trackValue(show, i * packed.divisor[n], n);
+        }
+    }
+
+    removeChunk(packed, CHUNK_RATES);
+
+    if (!isUniform(packed)) {
+        chunk_t rates;
+        memcpy(rates.tag, CHUNK_RATES, 5);
+        rates.data.assign(packed.divisor, packed.divisor + MAX_SERVOS);
+        packed.chunks.push_back(rates);
+    }
+
+    packed.image[SHOW_VERSION_BYTE] = isUniform(packed) ? std::min(show.image[SHOW_VERSION_BYTE], (uint8_t)1) : SHOW_VERSION;
+    show = packed;
+}
+
+/**
+*   @brief  Find the largest divisor whose resampled track stays within the tolerance of the original
+*
+*   @param  show    Loaded show
+*   @param  number  Servo number, 0 ... 63
+*   @return Returns the rate divisor, 1 ... MAX_DIVISOR
+*/
+uint8_t pickDivisor(const show_t &show, uint8_t number) {
+    std::vector<uint8_t> full(show.frames);
+    std::vector<uint8_t> track;
+
+    for (uint32_t f = 0; f < show.frames; f++) {
+        full[f] = trackValue(show, f, number);
+    }
+
+    for (uint8_t divisor = MAX_DIVISOR; divisor > 1; divisor--) {
+        uint32_t length = showTrackLength(show.frames, divisor);
+        bool fits = true;
+
+        track.resize(length);
+
+        for (uint32_t i = 0; i < length; i++) {
+            track[i] = full[i * divisor];
+        }
+
+        for (uint32_t f = 0; f < show.frames && fits; f++) {
+            fits = abs(readTrack(track.data(), length, f, divisor) - full[f]) <= options.tolerance;
+        }
+
+        if (fits) {
+            return divisor;
+        }
+    }
+
+    return 1;
+}
+
+/**
+*   @brief  Print the header, chunks and per servo statistics of a show
+*/
+void infoShow(const show_t &show, std::string &report) {
+    char line[160];
+    uint8_t servoCount = getServoCount(show);
+    const uint8_t* h = show.image.data();
+    char name[17] = {};
+
+    memcpy(name, h + SHOW_NAME, 16);
+
+    snprintf(line, sizeof(line), "  Show %u \"%s\" | %u ms | %u frames | version %u\n",
+        h[SHOW_NUMBER], name, readLE(h + SHOW_MS, 4), show.frames, h[SHOW_VERSION_BYTE]);
+    report += line;
+    snprintf(line, sizeof(line), "  Tracks: %u servos | %u of %u bytes | key %08X\n", servoCount,
+        show.trackStart[servoCount], SHOW_HEADER, crc32(0, h, std::min(show.trackStart[servoCount], (uint32_t)SHOW_HEADER)));
+    report += line;
+
+    for (const chunk_t &chunk : show.chunks) {
+        snprintf(line, sizeof(line), "  Chunk %s: %zu bytes\n", chunk.tag, chunk.data.size());
+        report += line;
+    }
+
+    report += "  Servo  Rate   Min  Max  Mean  Moves  Max step\n";
+
+    for (uint8_t n = 0; n < servoCount; n++) {
+        uint32_t length = show.trackStart[n + 1] - show.trackStart[n];
+        const uint8_t* track = h + show.trackStart[n];
+        uint8_t low = 255;
+        uint8_t high = 0;
+        uint64_t total = 0;
+        uint32_t moves = 0;
+        int maxStep = 0;
+
+        for (uint32_t i = 0; i < length; i++) {
+            low = std::min(low, track[i]);
+            high = std::max(high, track[i]);
+            total += track[i];
+
+            if (i > 0 && track[i] != track[i - 1]) {
+                moves++;
+                maxStep = std::max(maxStep, abs(track[i] - track[i - 1]));
+            }
+        }
+
+        snprintf(line, sizeof(line), "  %5u  1/%-3u %4u %4u %5u %6u %9.1f\n", n, show.divisor[n], low, high,
+            (unsigned)(length ? total / length : 0), moves, (double)maxStep / show.divisor[n]);
+        report += line;
+    }
+}
+
+/**
+*   @brief  Check a show against everything the controller expects of it
+*
+*   @return ```true``` if the show is good and ```false``` if not
+*/
+bool verifyShow(const std::string &path, const show_t &show, std::string &report) {
+    std::vector<std::string> errors;
+    const uint8_t* h = show.image.data();
+    uint8_t version = h[SHOW_VERSION_BYTE];
+    uint8_t servoCount = getServoCount(show);
+    uint32_t showMS = readLE(h + SHOW_MS, 4);
+    char text[96];
+
+    if (memcmp(h + SHOW_MAGIC, SHOW_MAGIC_DATA, sizeof(SHOW_MAGIC_DATA)) != 0) {
+        errors.push_back("bad magic");
+    }
+
+    if (version > SHOW_VERSION) {
+        snprintf(text, sizeof(text), "version %u is newer than %u", version, SHOW_VERSION);
+        errors.push_back(text);
+    }
+
+    std::string base = path.substr(path.find_last_of('/') + 1);
+
+    if (atoi(base.c_str()) != h[SHOW_NUMBER]) {
+        snprintf(text, sizeof(text), "header number %u does not match the file name", h[SHOW_NUMBER]);
+        errors.push_back(text);
+    }
+
+    if (show.frames == 0) {
+        errors.push_back("show length is 0");
+    }
+
+    if (show.trackStart[servoCount] > SHOW_HEADER) {
+        snprintf(text, sizeof(text), "%u servo tracks need %u bytes", servoCount, show.trackStart[servoCount]);
+        errors.push_back(text);
+    }
+
+    if (show.truncated) {
+        errors.push_back("last chunk runs past the end of the file");
+    }
+
+    if (version == 0 && !show.chunks.empty()) {
+        errors.push_back("version 0 file has chunks the controller will ignore");
+    }
+
+    const chunk_t* events = NULL;
+    const chunk_t* index = NULL;
+
+    for (const chunk_t &chunk : show.chunks) {
+        if (memcmp(chunk.tag, CHUNK_EVENTS, 4) == 0) {
+            events = &chunk;
+        } else if (memcmp(chunk.tag, CHUNK_INDEX, 4) == 0) {
+            index = &chunk;
+        } else if (memcmp(chunk.tag, CHUNK_RATES, 4) == 0) {
+            if (chunk.data.size() != MAX_SERVOS) {
+                errors.push_back("RATE chunk is not 64 bytes");
+            }
+
+            if (version < 2) {
+                errors.push_back("RATE chunk in a version 1 file");
+            }
+
+            if (std::find(chunk.data.begin(), chunk.data.end(), 0) != chunk.data.end()) {
+                errors.push_back("RATE chunk has a divisor of 0");
+            }
+        } else if (memcmp(chunk.tag, CHUNK_CRCS, 4) == 0) {
+            if (chunk.data.size() != CRC_BLOCKS * 4) {
+                errors.push_back("BCRC chunk is not 512 bytes");
+                continue;
+            }
+
+            for (uint8_t b = 0; b < CRC_BLOCKS; b++) {
+                if (readLE(&chunk.data[b * 4], 4) != crc32(0, h + (b * CRC_BLOCK_SIZE), crcBlockSize(b))) {
+                    snprintf(text, sizeof(text), "block %u does not match its BCRC entry", b);
+                    errors.push_back(text);
+                }
+            }
+        }
+    }
+
+    uint32_t eventCount = 0;
+
+    if (events != NULL) {
+        eventCount = events->data.size() / EVENT_BYTE_SIZE;
+
+        if (events->data.size() % EVENT_BYTE_SIZE != 0) {
+            errors.push_back("EVNT chunk is not a whole number of events");
+        }
+
+        for (uint32_t e = 0; e < eventCount; e++) {
+            uint32_t ms = readLE(&events->data[e * EVENT_BYTE_SIZE], 4);
+
+            if (e > 0 && ms < readLE(&events->data[(e - 1) * EVENT_BYTE_SIZE], 4)) {
+                errors.push_back("events are not in time order");
+                break;
+            }
+
+            if (ms > showMS) {
+                errors.push_back("event after the end of the show");
+                break;
+            }
+        }
+    }
+
+    if (index != NULL) {
+        uint32_t blocks = (show.frames / INDEX_BLOCK_FRAMES) + 1;
+
+        if (index->data.size() != blocks * 2) {
+            errors.push_back("BIDX chunk does not match the show length");
+        } else {
+            // Each entry is the first event at or after the start of its block
+            uint32_t e = 0;
+
+            for (uint32_t b = 0; b < blocks; b++) {
+                uint32_t blockMS = b * INDEX_BLOCK_FRAMES * SAMPLE_RATE;
+
+                while (e < eventCount && readLE(&events->data[e * EVENT_BYTE_SIZE], 4) < blockMS) {
+                    e++;
+                }
+
+                if (readLE(&index->data[b * 2], 2) != e) {
+                    errors.push_back("BIDX chunk does not match the events");
+                    break;
+                }
+            }
+        }
+    }
+
+    for (const std::string &error : errors) {
+        report += "  Error: " + error + "\n";
+    }
+
+    return errors.empty();
+}
+
+/**
+*   @brief  Run the command on one file
+*
+*   @param  path    File to work on
+*   @param  report  Returns the text to print for the file
+*   @return ```true``` if the file was handled and ```false``` if there was an error
+*/
+bool processFile(const std::string &path, std::string &report) {
+    show_t show;
+    std::string error;
+
+    report = path + "\n";
+
+    if (!readShow(path, show, error)) {
+        report += "  Error: " + error + "\n";
+        return false;
+    }
+
+    // verify reports this itself along with everything else wrong with the file
+    if (options.command != "verify" && !tracksFit(show)) {
+        report += "  Error: " + std::to_string(getServoCount(show)) + " servo tracks do not fit in the show data\n";
+        return false;
+    }
+
+    if (options.command == "info") {
+        infoShow(show, report);
+        return true;
+    }
+
+    if (options.command == "verify") {
+        bool good = verifyShow(path, show, report);
+        report += good ? "  OK\n" : "";
+        return good;
+    }
+
+    uint8_t servoCount = getServoCount(show);
+    uint32_t before = show.trackStart[servoCount];
+
+    if (options.command == "convert") {
+        uint8_t uniform[MAX_SERVOS];
+        memset(uniform, 1, sizeof(uniform));
+
+        if (options.version < 2) {
+            repackShow(show, uniform, servoCount);
+        }
+
+        if (show.trackStart[servoCount] > SHOW_HEADER) {
+            report += "  Error: the tracks do not fit at one sample per frame\n";
+            return false;
+        }
+
+        if (options.version == 0 && !show.chunks.empty()) {
+            report += "  Warning: events are dropped, version 0 has no chunks\n";
+            show.chunks.clear();
+        }
+
+        show.image[SHOW_VERSION_BYTE] = options.version;
+    } else if (options.command == "optimize") {
+        uint8_t divisor[MAX_SERVOS];
+
+        for (uint8_t n = 0; n < MAX_SERVOS; n++) {
+            divisor[n] = (n < servoCount) ? pickDivisor(show, n) : 1;
+        }
+
+        repackShow(show, divisor, servoCount);
+    } else if (options.command == "quantize") {
+        for (uint32_t a = 0; a < show.trackStart[servoCount] && a < SHOW_HEADER; a++) {
+            uint32_t value = ((show.image[a] + (options.step / 2)) / options.step) * options.step;
+            show.image[a] = std::min(value, (uint32_t)255);
+        }
+    }
+
+    // The tracks changed, the controller would hold every block whose old CRC no longer matches
+    stampCrcs(show);
+
+    std::string out = options.outDir.empty() ? path : options.outDir + "/" + path.substr(path.find_last_of('/') + 1);
+
+    if (!writeShow(out, show, error)) {
+        report += "  Error: " + error + "\n";
+        return false;
+    }
+
+    char line[96];
+    snprintf(line, sizeof(line), "  Tracks %u -> %u bytes, written to %s\n", before, show.trackStart[servoCount], out.c_str());
+    report += line;
+
+    return true;
+}
+
+/**
+*   @brief  Add a file, or every NNN.ANI file in a directory, to the work list
+*/
+void addPath(const std::string &path, std::vector<std::string> &files) {
+    struct stat info;
+
+    if (stat(path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+        files.push_back(path);
+        return;
+    }
+
+    DIR* dir = opendir(path.c_str());
+    struct dirent* entry;
+    std::vector<std::string> found;
+
+    while (dir != NULL && (entry = readdir(dir)) != NULL) {
+        const char* dot = strrchr(entry->d_name, '.');
+
+        if (dot != NULL && strcasecmp(dot, ".ANI") == 0) {
+            found.push_back(path + "/" + entry->d_name);
+        }
+    }
+
+    if (dir != NULL) {
+        closedir(dir);
+    }
+
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
+
+void printUsage() {
+    fprintf(stderr,
+        "Usage: anitool COMMAND [options] FILE|DIR...\n"
+        "  info                 Print the header, chunks and per servo statistics\n"
+        "  verify               Check the files, exits with 1 if any file is bad\n"
+        "  convert -v 0|1       Unpack the tracks to one sample per frame and write that version\n"
+        "  optimize [-t N]      Pick the largest rate divisor per servo within N steps of the original (2)\n"
+        "  quantize -s N        Round every sample to a multiple of N\n"
+        "Options:\n"
+        "  -n N     Number of servo tracks, default is as many as fit\n"
+        "  -o DIR   Write to DIR instead of over the original files\n"
+        "  -j N     Worker threads, default is one per core\n");
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> files;
+
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+
+    options.command = argv[1];
+
+    for (int a = 2; a < argc; a++) {
+        std::string arg = argv[a];
+
+        if (arg.size() == 2 && arg[0] == '-' && a + 1 < argc) {
+            const char* value = argv[++a];
+
+            switch (arg[1]) {
+                case 'n': options.servos = std::min(atoi(value), (int)MAX_SERVOS); break;
+                case 'v': options.version = atoi(value); break;
+                case 't': options.tolerance = atoi(value); break;
+                case 's': options.step = std::max(atoi(value), 1); break;
+                case 'o': options.outDir = value; break;
+                case 'j': options.jobs = atoi(value); break;
+                default: printUsage(); return 2;
+            }
+        } else {
+            addPath(arg, files);
+        }
+    }
+
+    bool known = options.command == "info" || options.command == "verify" || options.command == "optimize" ||
+        options.command == "quantize" || (options.command == "convert" && (options.version == 0 || options.version == 1));
+
+    if (!known || files.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    // The CRC table is built on first use, build it before the workers share it
+    crc32(0, NULL, 0);
+
+    std::vector<std::string> reports(files.size());
+    std::vector<char> results(files.size(), 0);
+    std::atomic<size_t> next(0);
+    unsigned jobs = (options.jobs > 0) ? options.jobs : std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::thread> workers;
+
+    for (unsigned j = 0; j < std::min((size_t)jobs, files.size()); j++) {
+        workers.push_back(std::thread([&]() {
+            for (size_t f = next++; f < files.size(); f = next++) {
+                results[f] = processFile(files[f], reports[f]);
+            }
+        }));
+    }
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    uint32_t failed = 0;
+
+    for (size_t f = 0; f < files.size(); f++) {
+        fputs(reports[f].c_str(), stdout);
+        failed += results[f] ? 0 : 1;
+    }
+
+    printf("%zu files, %u failed\n", files.size(), failed);
+
+    return (failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+/**
+*   @file   channelbench.cpp
+*   @brief  Times the frame loop specialized for a fixed servo count against the generic loop on a PC
+*
+*   Build: g++ -std=c++11 -O2 -o channelbench channelbench.cpp
+*   Use:   ./channelbench [passes]
+*
+*   Both loops come from ../channels.h, the same template the controller plays shows with.
+*   The output does the filter and map of computeServo() so the loop is timed with the work
+*   it carries on the controller. The outputs of both loops are compared, a mismatch fails.
+*/
+
+#include "../channels.h"
+#include "../layout.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define SHOW_FRAMES 6000  // One minute of show
+
+/**
+*   @brief  Struct for the bench servos, the same interface playChannels() uses on the controller
+*/
+struct benchServos_t {
+    uint8_t leads[MAX_SERVOS];
+    float filtered[MAX_SERVOS];
+    uint16_t ticks[MAX_SERVOS];
+    uint32_t checksum;
+
+    bool enabled(uint8_t s) {
+        return (s % 8) != 7;  // A few unused channels, like a real figure
+    }
+
+    uint8_t lead(uint8_t s) {
+        return leads[s];
+    }
+
+    void play(uint8_t s, uint8_t value) {
+        // The filter and map of computeServo()
+        filtered[s] = (filtered[s] * 0.75f) + (value * 0.25f);
+        ticks[s] = 150 + (uint16_t)((filtered[s] * 450) / 255);
+        checksum = (checksum * 31) + ticks[s];
+    }
+};
+
+/**
+*   @brief  Reset the bench servos to the same start for every run
+*
+*   @param  servos  Servos to reset
+*/
+void resetServos(benchServos_t &servos) {
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
+        servos.leads[s] = s % 4;
+        servos.filtered[s] = 127;
+        servos.ticks[s] = 0;
+    }
+
+    servos.checksum = 0;
+}
+
+/**
+*   @brief  Play every frame of the show a number of times with one loop
+*
+*   @param  tracks  Show tracks, SHOW_FRAMES samples per servo
+*   @param  count   Number of servos
+*   @param  passes  Times to play the show
+*   @param  servos  Returns the checksum of the output
+*   @return Returns the nanoseconds per frame
+*/
+template <uint8_t CHANNELS>
+double timeLoop(const std::vector<uint8_t> &tracks, uint8_t count, uint32_t passes, benchServos_t &servos) {
+    resetServos(servos);
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t p = 0; p < passes; p++) {
+        for (uint32_t f = 0; f < SHOW_FRAMES; f++) {
+            playChannels<CHANNELS>(tracks.data(), f, SHOW_FRAMES, count, servos);
+        }
+    }
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / ((double)passes * SHOW_FRAMES);
+}
+
+/**
+*   @brief  Time the generic and the specialized loop for one servo count and print the result
+*
+*   @param  tracks  Show tracks
+*   @param  passes  Times to play the show
+*   @return Returns ```true``` if both loops gave the same output and ```false``` if not
+*/
+template <uint8_t CHANNELS>
+bool benchCount(const std::vector<uint8_t> &tracks, uint32_t passes) {
+    benchServos_t generic;
+    benchServos_t fixed;
+
+    // Warm the cache and the branch predictors before timing either one
+    timeLoop<0>(tracks, CHANNELS, 1, generic);
+
+    double genericNS = timeLoop<0>(tracks, CHANNELS, passes, generic);
+    double fixedNS = timeLoop<CHANNELS>(tracks, CHANNELS, passes, fixed);
+    bool same = (generic.checksum == fixed.checksum);
+
+    printf("%8u %12.1f %12.1f %8.2fx  %s\n", CHANNELS, genericNS, fixedNS, genericNS / fixedNS, same ? "OK" : "MISMATCH");
+
+    return same;
+}
+
+int main(int argc, char** argv) {
+    uint32_t passes = (argc > 1) ? atoi(argv[1]) : 50;
+    std::vector<uint8_t> tracks(SHOW_FRAMES * MAX_SERVOS);
+
+    // Smooth motion with some noise, like a recorded show
+    srand(1);
+
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
+        int value = 127;
+
+        for (uint32_t f = 0; f < SHOW_FRAMES; f++) {
+            value += (rand() % 7) - 3;
+            value = (value < 0) ? 0 : (value > 255) ? 255 : value;
+            tracks[(s * SHOW_FRAMES) + f] = value;
+        }
+    }
+
+    printf("Passes: %u of %u frames\n", passes, SHOW_FRAMES);
+    printf("Channels   Generic ns     Fixed ns  Speedup\n");
+
+    bool good = benchCount<8>(tracks, passes);
+    good = benchCount<16>(tracks, passes) && good;
+    good = benchCount<32>(tracks, passes) && good;
+    good = benchCount<64>(tracks, passes) && good;
+
+    return good ? 0 : 1;
+}
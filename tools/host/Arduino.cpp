@@ -0,0 +1,328 @@
+/**
+*   @file   Arduino.cpp
+*   @brief  Host stand in for the Teensy core, the virtual clock, pins and serial ports
+*/
+
+#include "Arduino.h"
+#include <vector>
+
+#define HOST_MAX_PINS 64
+#define HOST_EPOCH 1767225600UL  // Real time clock at the start of a run, 2026-01-01 00:00
+
+/**
+*   @brief  Struct for a function the virtual clock calls every period
+*/
+struct periodic_t {
+    uint32_t periodUS;
+    uint64_t nextUS;
+    void (*callback)(void);
+};
+
+Stream Serial;
+Stream Serial1;
+Stream Serial2;
+teensy3_clock_class Teensy3Clock;
+
+uint64_t hostClockUS = 0;
+uint8_t irqDepth = 0;  // Periodic work waits while interrupts are off
+bool irqPending = false;
+uint8_t pinLevel[HOST_MAX_PINS] = {};
+uint32_t randomState = 1;
+uint64_t pollClockUS = 0;  // Clock after the last poll, unchanged since if nothing else charged time
+uint32_t pollStepUS = HOST_CALL_US;
+uint32_t pollStepMaxUS = HOST_CALL_US;
+
+// A function static, the audio streams register from global constructors in other files
+std::vector<periodic_t> &periodicList() {
+    static std::vector<periodic_t> list;
+    return list;
+}
+
+/**
+*   @brief  Run the periodic work that has fallen due, unless interrupts are off
+*/
+void runPeriodic() {
+    if (irqDepth > 0) {
+        irqPending = true;
+        return;
+    }
+
+    irqPending = false;
+
+    for (periodic_t &p : periodicList()) {
+        while (hostClockUS >= p.nextUS) {
+            p.nextUS += p.periodUS;
+            p.callback();
+        }
+    }
+}
+
+void hostAdvance(uint32_t us) {
+    hostClockUS += us;
+    runPeriodic();
+}
+
+void hostPoll() {
+    pollStepUS = (hostClockUS == pollClockUS) ? min(pollStepUS * 2, pollStepMaxUS) : HOST_CALL_US;
+    hostAdvance(pollStepUS);
+    pollClockUS = hostClockUS;
+}
+
+void hostSkipIdle(uint32_t maxUS) {
+    pollStepMaxUS = max(maxUS, (uint32_t)HOST_CALL_US);
+}
+
+uint64_t hostNow() {
+    return hostClockUS;
+}
+
+void hostEvery(uint32_t periodUS, void (*callback)(void)) {
+    periodicList().push_back({periodUS, hostClockUS + periodUS, callback});
+}
+
+void hostSetPin(uint8_t pin, uint8_t value) {
+    pinLevel[pin % HOST_MAX_PINS] = value;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+uint32_t millis() {
+    hostPoll();
+    return hostClockUS / 1000;
+}
+
+uint32_t micros() {
+    hostPoll();
+    return (uint32_t)hostClockUS;
+}
+
+void delay(uint32_t ms) {
+    hostAdvance(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    hostAdvance(us);
+}
+
+void yield() {
+    hostPoll();
+}
+
+int analogRead(uint8_t pin) {
+    return 512;
+}
+
+void analogWrite(uint8_t pin, int value) {
+    pinLevel[pin % HOST_MAX_PINS] = (value > 0) ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pinLevel[pin % HOST_MAX_PINS];
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    pinLevel[pin % HOST_MAX_PINS] = value;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+uint8_t digitalPinToInterrupt(uint8_t pin) {
+    return pin;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode) {
+}
+
+void detachInterrupt(uint8_t interrupt) {
+}
+
+void noInterrupts() {
+    __disable_irq();
+}
+
+void interrupts() {
+    __enable_irq();
+}
+
+void __disable_irq() {
+    irqDepth++;
+}
+
+void __enable_irq() {
+    if (irqDepth > 0) {
+        irqDepth--;
+    }
+
+    if (irqDepth == 0 && irqPending) {
+        runPeriodic();
+    }
+}
+
+long random(long howBig) {
+    // Same sequence on every run, so two runs of a harness can be compared
+    randomState = (randomState * 1103515245UL) + 12345UL;
+    return (howBig > 0) ? (long)((randomState >> 8) % howBig) : 0;
+}
+
+long random(long howSmall, long howBig) {
+    return (howBig > howSmall) ? howSmall + random(howBig - howSmall) : howSmall;
+}
+
+void randomSeed(unsigned long seed) {
+    randomState = (seed != 0) ? seed : 1;
+}
+
+unsigned long teensy3_clock_class::get() {
+    return HOST_EPOCH + (hostClockUS / 1000000);
+}
+
+size_t Print::write(uint8_t value) {
+    return 1;
+}
+
+size_t Print::write(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        write(data[i]);
+    }
+
+    return size;
+}
+
+int Print::availableForWrite() {
+    return 4096;
+}
+
+size_t Print::print(const char* text) {
+    return write((const uint8_t*)text, strlen(text));
+}
+
+size_t Print::print(char value) {
+    return write((uint8_t)value);
+}
+
+size_t Print::print(unsigned char value, int base) {
+    return print((unsigned long long)value, base);
+}
+
+size_t Print::print(int value, int base) {
+    return print((long long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return print((unsigned long long)value, base);
+}
+
+size_t Print::print(long value, int base) {
+    return print((long long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return print((unsigned long long)value, base);
+}
+
+size_t Print::print(long long value, int base) {
+    if (value < 0 && base == 10) {
+        return print('-') + print((unsigned long long)-value, base);
+    }
+
+    return print((unsigned long long)value, base);
+}
+
+size_t Print::print(unsigned long long value, int base) {
+    char text[72];
+    char* p = text + sizeof(text) - 1;
+    *p = 0;
+
+    do {
+        uint8_t digit = value % base;
+        *--p = (digit < 10) ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+    } while (value > 0);
+
+    return print(p);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return print(text);
+}
+
+size_t Print::println() {
+    return print("\r\n");
+}
+
+int Stream::available() {
+    return (uint16_t)(inputTail - inputHead);
+}
+
+int Stream::read() {
+    if (available() <= 0) {
+        return -1;
+    }
+
+    return (uint8_t)input[inputHead++ % sizeof(input)];
+}
+
+int Stream::peek() {
+    return (available() > 0) ? (uint8_t)input[inputHead % sizeof(input)] : -1;
+}
+
+long Stream::parseInt() {
+    long value = 0;
+    bool negative = false;
+
+    while (available() > 0 && peek() != '-' && (peek() < '0' || peek() > '9')) {
+        read();
+    }
+
+    if (peek() == '-') {
+        negative = true;
+        read();
+    }
+
+    while (available() > 0 && peek() >= '0' && peek() <= '9') {
+        value = (value * 10) + (read() - '0');
+    }
+
+    return negative ? -value : value;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+
+    while (count < length && available() > 0) {
+        buffer[count++] = read();
+    }
+
+    return count;
+}
+
+void Stream::hostInput(const char* text) {
+    while (*text != 0 && available() < (int)sizeof(input)) {
+        input[inputTail++ % sizeof(input)] = *text++;
+    }
+}
+
+void Stream::hostEcho(bool echo) {
+    this->echo = echo;
+}
+
+size_t Stream::write(uint8_t value) {
+    if (echo && value != '\r') {
+        fputc(value, stdout);
+    }
+
+    return 1;
+}
+
+size_t Stream::write(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        write(data[i]);
+    }
+
+    return size;
+}
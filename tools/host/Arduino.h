@@ -0,0 +1,207 @@
+/**
+*   @file   Arduino.h
+*   @brief  Host stand in for the Teensy core, with a virtual clock the harnesses in tools/ drive
+*
+*   Every micros() or millis() call moves the clock on by HOST_CALL_US, so the busy waits of
+*   the frame loop make progress, and the SD and I2C fakes charge the time their transfers take.
+*   Periodic work such as the audio interrupt runs from the clock as it passes each period.
+*   With hostSkipIdle() a loop that only polls the clock moves it on in growing steps, so long
+*   runs do not spend their time on the waits between frames.
+*/
+
+#ifndef HOST_ARDUINO_H_
+    #define HOST_ARDUINO_H_
+
+    #include <math.h>
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <string.h>
+    #include <strings.h>
+    #include <utility>
+
+    #define HOST_CALL_US 1  // Time a call to micros() or millis() costs
+
+    #define INPUT 0
+    #define OUTPUT 1
+    #define INPUT_PULLUP 2
+    #define INPUT_PULLDOWN 3
+    #define LOW 0
+    #define HIGH 1
+    #define CHANGE 4
+    #define FALLING 2
+    #define RISING 3
+    #define BUILTIN_SDCARD 254
+    #define DMAMEM
+    #define EXTMEM
+    #define FASTRUN
+    #define PROGMEM
+
+    // Templates like the Teensy 4 core, so the STL headers can still be included after this one
+    template <class A, class B>
+    constexpr auto min(A &&a, B &&b) -> decltype(a < b ? std::forward<A>(a) : std::forward<B>(b)) {
+        return a < b ? std::forward<A>(a) : std::forward<B>(b);
+    }
+
+    template <class A, class B>
+    constexpr auto max(A &&a, B &&b) -> decltype(a < b ? std::forward<A>(a) : std::forward<B>(b)) {
+        return a >= b ? std::forward<A>(a) : std::forward<B>(b);
+    }
+
+    #define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+    long map(long x, long inMin, long inMax, long outMin, long outMax);
+    uint32_t millis(void);
+    uint32_t micros(void);
+    void delay(uint32_t ms);
+    void delayMicroseconds(uint32_t us);
+    void yield(void);
+    int analogRead(uint8_t pin);
+    void analogWrite(uint8_t pin, int value);
+    int digitalRead(uint8_t pin);
+    void digitalWrite(uint8_t pin, uint8_t value);
+    void pinMode(uint8_t pin, uint8_t mode);
+    uint8_t digitalPinToInterrupt(uint8_t pin);
+    void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+    void detachInterrupt(uint8_t interrupt);
+    void noInterrupts(void);
+    void interrupts(void);
+    void __disable_irq(void);
+    void __enable_irq(void);
+    long random(long howBig);
+    long random(long howSmall, long howBig);
+    void randomSeed(unsigned long seed);
+
+    /**
+    *   @brief  Class for text and byte output, the same print overloads as the Arduino core
+    */
+    class Print {
+        public:
+            virtual ~Print() {}
+            virtual size_t write(uint8_t value);
+            virtual size_t write(const uint8_t* data, size_t size);
+            virtual int availableForWrite(void);
+            size_t print(const char* text);
+            size_t print(char value);
+            size_t print(unsigned char value, int base = 10);
+            size_t print(int value, int base = 10);
+            size_t print(unsigned int value, int base = 10);
+            size_t print(long value, int base = 10);
+            size_t print(unsigned long value, int base = 10);
+            size_t print(long long value, int base = 10);
+            size_t print(unsigned long long value, int base = 10);
+            size_t print(double value, int digits = 2);
+            size_t println(void);
+
+            template <typename T>
+            size_t println(T value) {
+                return print(value) + println();
+            }
+
+            template <typename T>
+            size_t println(T value, int format) {
+                return print(value, format) + println();
+            }
+
+            void flush(void) {}
+    };
+
+    /**
+    *   @brief  Class for a byte stream, input comes from hostInput()
+    */
+    class Stream : public Print {
+        public:
+            virtual int available(void);
+            virtual int read(void);
+            virtual int peek(void);
+            long parseInt(void);
+            size_t readBytes(char* buffer, size_t length);
+            void setTimeout(uint32_t ms) {}
+            void begin(uint32_t baud) {}
+            operator bool() {
+                return true;
+            }
+
+            /**
+            *   @brief  Queue bytes for the firmware to read
+            *
+            *   @param  text    Bytes to queue
+            */
+            void hostInput(const char* text);
+
+            /**
+            *   @brief  Turn printing to stdout on or off, on by default
+            *
+            *   @param  echo    ```true``` to print and ```false``` to drop the output
+            */
+            void hostEcho(bool echo);
+
+            size_t write(uint8_t value) override;
+            size_t write(const uint8_t* data, size_t size) override;
+
+        private:
+            char input[256];
+            uint16_t inputHead = 0;
+            uint16_t inputTail = 0;
+            bool echo = true;
+    };
+
+    extern Stream Serial;
+    extern Stream Serial1;
+    extern Stream Serial2;
+
+    /**
+    *   @brief  Struct for the real time clock
+    */
+    struct teensy3_clock_class {
+        static unsigned long get(void);
+    };
+
+    extern teensy3_clock_class Teensy3Clock;
+
+    /**
+    *   @brief  Move the virtual clock on, running any periodic work that falls due
+    *
+    *   @param  us  Microseconds to move on
+    */
+    void hostAdvance(uint32_t us);
+
+    /**
+    *   @brief  Charge the time of a clock or status read, the step grows while nothing else charges time
+    */
+    void hostPoll(void);
+
+    /**
+    *   @brief  Let polls in a row double their step, to skip through the waits of long runs
+    *
+    *   Clock reads measured across a wait can come back up to maxUS late
+    *
+    *   @param  maxUS   Longest step of a poll, HOST_CALL_US turns skipping off
+    */
+    void hostSkipIdle(uint32_t maxUS);
+
+    /**
+    *   @brief  Get the virtual clock without moving it
+    *
+    *   @return Returns the microseconds since the harness started
+    */
+    uint64_t hostNow(void);
+
+    /**
+    *   @brief  Run a function every period of the virtual clock, like a timer interrupt
+    *
+    *   @param  periodUS    Microseconds between calls
+    *   @param  callback    Function to call
+    */
+    void hostEvery(uint32_t periodUS, void (*callback)(void));
+
+    /**
+    *   @brief  Set the level digitalRead() returns for a pin
+    *
+    *   @param  pin     Pin number, 0 ... 63
+    *   @param  value   HIGH or LOW
+    */
+    void hostSetPin(uint8_t pin, uint8_t value);
+
+#endif  // HOST_ARDUINO_H_
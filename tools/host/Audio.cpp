@@ -0,0 +1,146 @@
+/**
+*   @file   Audio.cpp
+*   @brief  Host stand in for the Teensy Audio library, the update interrupt runs from the virtual clock
+*/
+
+#include "Audio.h"
+#include <vector>
+
+#define AUDIO_POOL_BLOCKS 64
+
+/**
+*   @brief  Struct for one connection of the audio graph
+*/
+struct connection_t {
+    AudioStream* source;
+    unsigned char sourceIndex;
+    AudioStream* destination;
+    unsigned char destinationIndex;
+};
+
+audio_block_t audioPool[AUDIO_POOL_BLOCKS];
+int audioBlocksUsed = 0;
+int audioBlocksMax = 0;
+
+// Function statics, the streams are made by global constructors in other files
+std::vector<AudioStream*> &audioStreams() {
+    static std::vector<AudioStream*> streams;
+    return streams;
+}
+
+std::vector<connection_t> &audioConnections() {
+    static std::vector<connection_t> connections;
+    return connections;
+}
+
+/**
+*   @brief  Update every stream, the audio interrupt
+*/
+void updateAudio() {
+    for (AudioStream* stream : audioStreams()) {
+        stream->update();
+    }
+
+    // A block nobody received is dropped, like the library does at the next update
+    for (AudioStream* stream : audioStreams()) {
+        for (unsigned char i = 0; i < stream->inputs; i++) {
+            if (stream->inputQueue[i] != NULL) {
+                audio_block_t* block = stream->inputQueue[i];
+                stream->inputQueue[i] = NULL;
+
+                if (--block->ref_count == 0) {
+                    audioBlocksUsed--;
+                }
+            }
+        }
+    }
+}
+
+AudioStream::AudioStream(unsigned char inputs, audio_block_t** queue) : inputs(inputs), inputQueue(queue) {
+    for (unsigned char i = 0; i < inputs; i++) {
+        inputQueue[i] = NULL;
+    }
+
+    if (audioStreams().empty()) {
+        hostEvery(AUDIO_BLOCK_US, updateAudio);
+    }
+
+    audioStreams().push_back(this);
+}
+
+audio_block_t* AudioStream::allocate() {
+    for (uint16_t b = 0; b < AUDIO_POOL_BLOCKS; b++) {
+        if (audioPool[b].ref_count == 0) {
+            audioPool[b].ref_count = 1;
+            audioPool[b].memory_pool_index = b;
+            audioBlocksUsed++;
+            audioBlocksMax = max(audioBlocksMax, audioBlocksUsed);
+
+            return &audioPool[b];
+        }
+    }
+
+    return NULL;
+}
+
+void AudioStream::release(audio_block_t* block) {
+    if (block != NULL && block->ref_count > 0 && --block->ref_count == 0) {
+        audioBlocksUsed--;
+    }
+}
+
+void AudioStream::transmit(audio_block_t* block, unsigned char index) {
+    for (const connection_t &c : audioConnections()) {
+        if (c.source != this || c.sourceIndex != index || c.destinationIndex >= c.destination->inputs) {
+            continue;
+        }
+
+        audio_block_t* &slot = c.destination->inputQueue[c.destinationIndex];
+
+        if (slot == NULL) {
+            slot = block;
+            block->ref_count++;
+        }
+    }
+}
+
+audio_block_t* AudioStream::receiveReadOnly(unsigned int index) {
+    if (index >= inputs) {
+        return NULL;
+    }
+
+    audio_block_t* block = inputQueue[index];
+    inputQueue[index] = NULL;
+
+    return block;
+}
+
+AudioConnection::AudioConnection(AudioStream &source, unsigned char sourceIndex, AudioStream &destination, unsigned char destinationIndex) {
+    audioConnections().push_back({&source, sourceIndex, &destination, destinationIndex});
+}
+
+void AudioAmplifier::update() {
+    audio_block_t* block = receiveReadOnly(0);
+
+    if (block != NULL) {
+        transmit(block);
+        release(block);
+    }
+}
+
+void AudioOutputPT8211::update() {
+    release(receiveReadOnly(0));
+    release(receiveReadOnly(1));
+}
+
+int AudioMemoryUsage() {
+    return audioBlocksUsed;
+}
+
+int AudioMemoryUsageMax() {
+    return audioBlocksMax;
+}
+
+void AudioMemoryUsageMaxReset() {
+    audioBlocksMax = audioBlocksUsed;
+}
@@ -0,0 +1,90 @@
+/**
+*   @file   Audio.h
+*   @brief  Host stand in for the Teensy Audio library, the update interrupt runs from the virtual clock
+*
+*   Every AUDIO_BLOCK_SAMPLES at 44.1 kHz each stream is updated in the order it was made,
+*   the same order the library uses. Blocks go from transmit() to the receiveReadOnly() of the
+*   connected inputs, and are counted so AudioMemoryUsageMax() reports the real peak.
+*/
+
+#ifndef HOST_AUDIO_H_
+    #define HOST_AUDIO_H_
+
+    #include "Arduino.h"
+
+    #define AUDIO_BLOCK_SAMPLES 128
+    #define AUDIO_SAMPLE_RATE_EXACT 44117.64706f
+    #define AUDIO_BLOCK_US 2902  // AUDIO_BLOCK_SAMPLES at AUDIO_SAMPLE_RATE_EXACT
+
+    /**
+    *   @brief  Struct for a block of samples
+    */
+    typedef struct audio_block_struct {
+        uint8_t ref_count;
+        uint8_t reserved1;
+        uint16_t memory_pool_index;
+        int16_t data[AUDIO_BLOCK_SAMPLES];
+    } audio_block_t;
+
+    /**
+    *   @brief  Class for a node of the audio graph
+    */
+    class AudioStream {
+        public:
+            AudioStream(unsigned char inputs, audio_block_t** queue);
+            virtual ~AudioStream() {}
+            virtual void update(void) = 0;
+
+            unsigned char inputs;
+            audio_block_t** inputQueue;
+
+        protected:
+            static audio_block_t* allocate(void);
+            static void release(audio_block_t* block);
+            void transmit(audio_block_t* block, unsigned char index = 0);
+            audio_block_t* receiveReadOnly(unsigned int index = 0);
+            bool active = true;
+    };
+
+    /**
+    *   @brief  Class for a connection from an output of one stream to an input of another
+    */
+    class AudioConnection {
+        public:
+            AudioConnection(AudioStream &source, unsigned char sourceIndex, AudioStream &destination, unsigned char destinationIndex);
+    };
+
+    /**
+    *   @brief  Class for the amplifier, blocks pass through
+    */
+    class AudioAmplifier : public AudioStream {
+        public:
+            AudioAmplifier(void) : AudioStream(1, queue) {}
+            void gain(float level) {}
+            void update(void) override;
+
+        private:
+            audio_block_t* queue[1];
+    };
+
+    /**
+    *   @brief  Class for the DAC, blocks are dropped
+    */
+    class AudioOutputPT8211 : public AudioStream {
+        public:
+            AudioOutputPT8211(void) : AudioStream(2, queue) {}
+            void update(void) override;
+
+        private:
+            audio_block_t* queue[2];
+    };
+
+    #define AudioMemory(n) ((void)(n))
+    #define AudioNoInterrupts() __disable_irq()
+    #define AudioInterrupts() __enable_irq()
+
+    int AudioMemoryUsage(void);
+    int AudioMemoryUsageMax(void);
+    void AudioMemoryUsageMaxReset(void);
+
+#endif  // HOST_AUDIO_H_
@@ -0,0 +1,285 @@
+/**
+*   @file   SD.cpp
+*   @brief  Host stand in for the SD library, files live in memory and transfers charge card time
+*/
+
+#include "SD.h"
+#include <map>
+
+/**
+*   @brief  Struct for an open file, shared by every copy of the File
+*/
+struct hostHandle_t {
+    std::string name;
+    std::shared_ptr<std::vector<uint8_t>> data;  // NULL for the root directory
+    uint64_t position;
+    size_t nextEntry;  // Directory only
+};
+
+SDClass SD;
+std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> cardFiles;
+std::map<std::string, uint32_t> cardScattered;  // How scattered each file written to a filling card is, 0 ... 100
+uint64_t cardCapacity = 0;
+uint64_t cardFillBytes = 0;
+
+/**
+*   @brief  Get a file name without the leading slash
+*
+*   @param  path    Path to a file in the root directory
+*   @return Returns the file name
+*/
+std::string fileKey(const char* path) {
+    return (path[0] == '/') ? std::string(path + 1) : std::string(path);
+}
+
+/**
+*   @brief  Get the space taken on the card
+*
+*   @return Returns the bytes of every file and of hostFill()
+*/
+uint64_t cardUsed() {
+    uint64_t used = cardFillBytes;
+
+    for (const auto &file : cardFiles) {
+        used += file.second->size();
+    }
+
+    return used;
+}
+
+/**
+*   @brief  Get how far the card is between starting to slow down and full
+*
+*   @return Returns 0 below HOST_SD_FILL_START ... 100 when full
+*/
+uint32_t cardScatter() {
+    uint32_t fill = SD.hostFillPercent();
+    return (fill > HOST_SD_FILL_START) ? ((fill - HOST_SD_FILL_START) * 100) / (100 - HOST_SD_FILL_START) : 0;
+}
+
+/**
+*   @brief  Move the virtual clock on by the card time of a transfer
+*
+*   @param  size        Bytes moved
+*   @param  sectorUS    Microseconds per 512 byte sector
+*   @param  percent     Sector time in percent of sectorUS
+*   @param  extraUS     Microseconds added to the call
+*/
+void chargeCard(uint64_t size, uint32_t sectorUS, uint32_t percent, uint32_t extraUS) {
+    hostAdvance(HOST_SD_CALL_US + extraUS + ((size * sectorUS * percent) / (512 * 100)));
+}
+
+int File::read() {
+    uint8_t value;
+    return (read(&value, 1) == 1) ? value : -1;
+}
+
+int File::read(void* data, size_t size) {
+    if (!handle || !handle->data) {
+        return -1;
+    }
+
+    uint64_t length = handle->data->size();
+    size_t count = (handle->position < length) ? min((uint64_t)size, length - handle->position) : 0;
+
+    memcpy(data, handle->data->data() + handle->position, count);
+    handle->position += count;
+
+    auto scattered = cardScattered.find(handle->name);
+    chargeCard(count, HOST_SD_READ_US, 100, (scattered != cardScattered.end()) ? (HOST_SD_SCATTER_US * scattered->second) / 100 : 0);
+
+    return count;
+}
+
+int File::peek() {
+    if (!handle || !handle->data || handle->position >= handle->data->size()) {
+        return -1;
+    }
+
+    return (*handle->data)[handle->position];
+}
+
+int File::available() {
+    if (!handle || !handle->data) {
+        return 0;
+    }
+
+    uint64_t length = handle->data->size();
+    return (handle->position < length) ? (int)min(length - handle->position, (uint64_t)0x7FFFFFFF) : 0;
+}
+
+size_t File::write(uint8_t value) {
+    return write(&value, 1);
+}
+
+size_t File::write(const uint8_t* data, size_t size) {
+    if (!handle || !handle->data) {
+        return 0;
+    }
+
+    std::vector<uint8_t> &file = *handle->data;
+    uint32_t scatter = cardScatter();
+
+    // A full card takes what fits and the write comes back short
+    if (cardCapacity > 0 && file.size() < handle->position + size) {
+        uint64_t room = cardCapacity - min(cardUsed(), cardCapacity);
+        size = min((uint64_t)size, (file.size() - handle->position) + room);
+    }
+
+    if (file.size() < handle->position + size) {
+        file.resize(handle->position + size);
+    }
+
+    memcpy(file.data() + handle->position, data, size);
+    handle->position += size;
+    chargeCard(size, HOST_SD_WRITE_US, 100 + (((HOST_SD_FULL_WRITE_PERCENT - 100) * scatter) / 100), 0);
+
+    if (scatter > 0) {
+        cardScattered[handle->name] = max(cardScattered[handle->name], scatter);
+    }
+
+    return size;
+}
+
+bool File::seek(uint64_t position) {
+    if (!handle || !handle->data || position > handle->data->size()) {
+        return false;
+    }
+
+    handle->position = position;
+    return true;
+}
+
+uint64_t File::position() {
+    return handle ? handle->position : 0;
+}
+
+uint64_t File::size() {
+    return (handle && handle->data) ? handle->data->size() : 0;
+}
+
+void File::close() {
+    handle.reset();
+}
+
+const char* File::name() {
+    return handle ? handle->name.c_str() : "";
+}
+
+bool File::isDirectory() {
+    return handle && !handle->data;
+}
+
+File File::openNextFile() {
+    File entry;
+
+    if (!isDirectory() || handle->nextEntry >= cardFiles.size()) {
+        return entry;
+    }
+
+    auto it = cardFiles.begin();
+    std::advance(it, handle->nextEntry++);
+    entry.handle = std::make_shared<hostHandle_t>(hostHandle_t{it->first, it->second, 0, 0});
+
+    return entry;
+}
+
+void File::rewindDirectory() {
+    if (isDirectory()) {
+        handle->nextEntry = 0;
+    }
+}
+
+bool File::truncate(uint64_t size) {
+    if (!handle || !handle->data) {
+        return false;
+    }
+
+    handle->data->resize(size);
+    handle->position = min(handle->position, size);
+
+    if (size == 0) {
+        cardScattered.erase(handle->name);
+    }
+
+    return true;
+}
+
+bool SDClass::exists(const char* path) {
+    return cardFiles.count(fileKey(path)) > 0;
+}
+
+File SDClass::open(const char* path, uint8_t mode) {
+    File file;
+    std::string key = fileKey(path);
+
+    if (key.empty()) {
+        file.handle = std::make_shared<hostHandle_t>(hostHandle_t{"/", nullptr, 0, 0});
+        return file;
+    }
+
+    auto it = cardFiles.find(key);
+
+    if (it == cardFiles.end()) {
+        if (mode == FILE_READ) {
+            return file;
+        }
+
+        it = cardFiles.emplace(key, std::make_shared<std::vector<uint8_t>>()).first;
+    }
+
+    // FILE_WRITE appends, FILE_WRITE_BEGIN writes over the file from the start
+    uint64_t position = (mode == FILE_WRITE) ? it->second->size() : 0;
+    file.handle = std::make_shared<hostHandle_t>(hostHandle_t{key, it->second, position, 0});
+
+    return file;
+}
+
+bool SDClass::remove(const char* path) {
+    cardScattered.erase(fileKey(path));
+    return cardFiles.erase(fileKey(path)) > 0;
+}
+
+bool SDClass::rename(const char* from, const char* to) {
+    auto it = cardFiles.find(fileKey(from));
+
+    // Like SdFat, the new name must not be taken
+    if (it == cardFiles.end() || exists(to)) {
+        return false;
+    }
+
+    cardFiles[fileKey(to)] = it->second;
+    cardFiles.erase(it);
+
+    auto scattered = cardScattered.find(fileKey(from));
+
+    if (scattered != cardScattered.end()) {
+        cardScattered[fileKey(to)] = scattered->second;
+        cardScattered.erase(scattered);
+    }
+
+    return true;
+}
+
+void SDClass::hostWrite(const char* path, const std::vector<uint8_t> &data) {
+    cardFiles[fileKey(path)] = std::make_shared<std::vector<uint8_t>>(data);
+    cardScattered.erase(fileKey(path));
+}
+
+std::vector<uint8_t> SDClass::hostRead(const char* path) {
+    auto it = cardFiles.find(fileKey(path));
+    return (it != cardFiles.end()) ? *it->second : std::vector<uint8_t>();
+}
+
+void SDClass::hostCapacity(uint64_t bytes) {
+    cardCapacity = bytes;
+}
+
+void SDClass::hostFill(uint64_t bytes) {
+    uint64_t used = cardUsed();
+    cardFillBytes += (cardCapacity > used) ? min(bytes, cardCapacity - used) : 0;
+}
+
+uint32_t SDClass::hostFillPercent() {
+    return (cardCapacity > 0) ? min((cardUsed() * 100) / cardCapacity, (uint64_t)100) : 0;
+}
@@ -0,0 +1,121 @@
+/**
+*   @file   SD.h
+*   @brief  Host stand in for the SD library, files live in memory and transfers charge card time
+*
+*   Only the root directory is kept, the controller keeps every file there. Reads and writes
+*   move the virtual clock on per sector, like the card would hold up the frame loop.
+*
+*   A card given a capacity slows down once it is more than half full: writes wait for the card
+*   to erase blocks, up to HOST_SD_FULL_WRITE_PERCENT of their time when it is full, and a file
+*   written while it was that full is scattered, so each read of it costs up to HOST_SD_SCATTER_US
+*   more. Writes past the capacity come back short.
+*/
+
+#ifndef HOST_SD_H_
+    #define HOST_SD_H_
+
+    #include "Arduino.h"
+    #include <memory>
+    #include <string>
+    #include <vector>
+
+    #define FILE_READ 0
+    #define FILE_WRITE 1
+    #define FILE_WRITE_BEGIN 2
+
+    #define HOST_SD_READ_US 40  // Per 512 byte sector
+    #define HOST_SD_WRITE_US 150  // Per 512 byte sector
+    #define HOST_SD_CALL_US 5  // Per read or write call
+    #define HOST_SD_FILL_START 50  // Percent full the card starts slowing down at
+    #define HOST_SD_FULL_WRITE_PERCENT 400  // Write time of a full card in percent of the normal time
+    #define HOST_SD_SCATTER_US 500  // Extra time per read call of a file written to a full card
+
+    struct hostHandle_t;
+
+    /**
+    *   @brief  Class for an open file or directory, copies share the same position
+    */
+    class File : public Stream {
+        public:
+            File(void) {}
+            int read(void) override;
+            int read(void* data, size_t size);
+            int peek(void) override;
+            int available(void) override;
+            size_t write(uint8_t value) override;
+            size_t write(const uint8_t* data, size_t size) override;
+            bool seek(uint64_t position);
+            uint64_t position(void);
+            uint64_t size(void);
+            void flush(void) {}
+            void close(void);
+            const char* name(void);
+            bool isDirectory(void);
+            File openNextFile(void);
+            void rewindDirectory(void);
+            bool truncate(uint64_t size = 0);
+            operator bool() {
+                return handle != nullptr;
+            }
+
+            std::shared_ptr<hostHandle_t> handle;
+    };
+
+    /**
+    *   @brief  Class for the card
+    */
+    class SDClass {
+        public:
+            bool begin(uint8_t pin) {
+                return true;
+            }
+
+            bool exists(const char* path);
+            File open(const char* path, uint8_t mode = FILE_READ);
+            bool remove(const char* path);
+            bool rename(const char* from, const char* to);
+            bool mkdir(const char* path) {
+                return true;
+            }
+
+            /**
+            *   @brief  Put a file on the card
+            *
+            *   @param  path    File name
+            *   @param  data    File contents
+            */
+            void hostWrite(const char* path, const std::vector<uint8_t> &data);
+
+            /**
+            *   @brief  Get a file from the card
+            *
+            *   @param  path    File name
+            *   @return Returns the file contents, empty if there is no such file
+            */
+            std::vector<uint8_t> hostRead(const char* path);
+
+            /**
+            *   @brief  Set the size of the card, files and hostFill() past it do not fit
+            *
+            *   @param  bytes   Card size in bytes, 0 for a card that never fills or slows down
+            */
+            void hostCapacity(uint64_t bytes);
+
+            /**
+            *   @brief  Take space on the card with files the controller never opens, logs or uploads
+            *
+            *   @param  bytes   Bytes to add, limited to the free space
+            */
+            void hostFill(uint64_t bytes);
+
+            /**
+            *   @brief  Get how full the card is
+            *
+            *   @return Returns the used space in percent of the capacity, 0 if it has none
+            */
+            uint32_t hostFillPercent(void);
+    };
+
+    extern SDClass SD;
+
+#endif  // HOST_SD_H_
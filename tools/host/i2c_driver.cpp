@@ -0,0 +1,105 @@
+/**
+*   @file   i2c_driver.cpp
+*   @brief  Host stand in for the Teensy 4 I2C masters, each a bus of PCA9685 register files that charges bus time
+*/
+
+#include "imx_rt1060/imx_rt1060_i2c_driver.h"
+
+#define I2C_FRAME_BITS 20  // Start, address byte with ack, stop
+#define I2C_BYTE_BITS 9  // 8 data bits and the ack
+
+IMX_RT1060_I2CMaster Master;
+IMX_RT1060_I2CMaster Master1;
+IMX_RT1060_I2CMaster Master2;
+
+void IMX_RT1060_I2CMaster::begin(uint32_t frequency) {
+    clockHz = max(frequency, (uint32_t)1000);
+    busy = false;
+    _error = I2CError::ok;
+}
+
+void IMX_RT1060_I2CMaster::complete() {
+    if (!busy || hostNow() < doneUS) {
+        return;
+    }
+
+    // The first byte picks the register, the rest go to it and the ones after it
+    if (txCount > 0) {
+        uint8_t reg = txBuffer[0];
+
+        for (size_t b = 1; b < txCount; b++) {
+            registers[txAddress][reg++] = txBuffer[b];
+        }
+    }
+
+    transferred = txCount;
+    busy = false;
+}
+
+bool IMX_RT1060_I2CMaster::finished() {
+    complete();
+
+    // Reading the status costs time, so a loop that waits on the bus moves the clock on
+    if (busy) {
+        hostPoll();
+    }
+
+    return !busy;
+}
+
+size_t IMX_RT1060_I2CMaster::get_bytes_transferred() {
+    complete();
+    return busy ? 0 : transferred;
+}
+
+void IMX_RT1060_I2CMaster::write_async(uint16_t address, const uint8_t* buffer, size_t num_bytes, bool send_stop) {
+    complete();
+
+    // The driver refuses a transfer while one is still on the bus
+    if (busy) {
+        _error = I2CError::master_not_ready;
+        overlaps++;
+        return;
+    }
+
+    uint32_t bits = I2C_FRAME_BITS + (num_bytes * I2C_BYTE_BITS);
+    uint32_t us = ((uint64_t)bits * 1000000 + clockHz - 1) / clockHz;
+
+    _error = I2CError::ok;
+    busy = true;
+    doneUS = hostNow() + us;
+    txAddress = address & 0x7F;
+    txBuffer = buffer;
+    txCount = num_bytes;
+    transferred = 0;
+
+    transfers++;
+    bytes += num_bytes;
+    busUS += us;
+}
+
+void IMX_RT1060_I2CMaster::read_async(uint16_t address, uint8_t* buffer, size_t num_bytes, bool send_stop) {
+    _error = I2CError::invalid_request;
+}
+
+uint8_t IMX_RT1060_I2CMaster::hostRegister(uint8_t address, uint8_t reg) {
+    complete();
+    return registers[address & 0x7F][reg];
+}
+
+void IMX_RT1060_I2CMaster::hostCounters(uint32_t* transfers, uint32_t* bytes, uint64_t* busUS) {
+    *transfers = this->transfers;
+    *bytes = this->bytes;
+    *busUS = this->busUS;
+}
+
+uint32_t IMX_RT1060_I2CMaster::hostOverlaps() {
+    return overlaps;
+}
+
+void IMX_RT1060_I2CMaster::hostReset() {
+    transfers = 0;
+    bytes = 0;
+    busUS = 0;
+    overlaps = 0;
+}
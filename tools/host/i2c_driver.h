@@ -0,0 +1,53 @@
+/**
+*   @file   i2c_driver.h
+*   @brief  Host stand in for the teensy4_i2c driver interface, transfers run on their own beside the caller
+*/
+
+#ifndef HOST_I2C_DRIVER_H_
+    #define HOST_I2C_DRIVER_H_
+
+    #include "Arduino.h"
+
+    /**
+    *   @brief  Errors a transfer can end with, the same values as the library
+    */
+    enum class I2CError {
+        ok = 0,
+        arbitration_lost = 1,
+        buffer_overflow = 2,
+        buffer_underflow = 3,
+        invalid_request = 4,
+        master_pin_low_timeout = 5,
+        master_not_ready = 6,
+        master_fifo_error = 7,
+        master_fifo_overflow = 8,
+        master_nak = 9,
+        master_fifo_underflow = 10
+    };
+
+    /**
+    *   @brief  Class for an I2C master whose transfers are driven by an interrupt
+    */
+    class I2CMaster {
+        public:
+            virtual ~I2CMaster() {}
+            virtual void begin(uint32_t frequency) = 0;
+            virtual void end(void) = 0;
+            virtual bool finished(void) = 0;
+            virtual size_t get_bytes_transferred(void) = 0;
+            virtual void write_async(uint16_t address, const uint8_t* buffer, size_t num_bytes, bool send_stop) = 0;
+            virtual void read_async(uint16_t address, uint8_t* buffer, size_t num_bytes, bool send_stop) = 0;
+
+            I2CError error(void) {
+                return _error;
+            }
+
+            bool has_error(void) {
+                return _error > I2CError::ok;
+            }
+
+        protected:
+            I2CError _error = I2CError::ok;
+    };
+
+#endif  // HOST_I2C_DRIVER_H_
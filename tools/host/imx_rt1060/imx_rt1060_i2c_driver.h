@@ -0,0 +1,82 @@
+/**
+*   @file   imx_rt1060_i2c_driver.h
+*   @brief  Host stand in for the Teensy 4 I2C masters, each a bus of PCA9685 register files that charges bus time
+*
+*   A write returns at once and the bus stays busy on the virtual clock for the time its bits take,
+*   9 bits per byte plus the start, address and stop, the way the LPI2C interrupt sends it on the
+*   controller. The bytes land in the registers of the device, with auto increment, when the
+*   transfer ends, so a caller that reuses its buffer while the bus is still busy is caught.
+*/
+
+#ifndef HOST_IMX_RT1060_I2C_DRIVER_H_
+    #define HOST_IMX_RT1060_I2C_DRIVER_H_
+
+    #include "../i2c_driver.h"
+
+    /**
+    *   @brief  Class for one of the I2C ports of the Teensy 4
+    */
+    class IMX_RT1060_I2CMaster : public I2CMaster {
+        public:
+            void begin(uint32_t frequency) override;
+            void end(void) override {}
+            bool finished(void) override;
+            size_t get_bytes_transferred(void) override;
+            void write_async(uint16_t address, const uint8_t* buffer, size_t num_bytes, bool send_stop) override;
+            void read_async(uint16_t address, uint8_t* buffer, size_t num_bytes, bool send_stop) override;
+
+            /**
+            *   @brief  Get a register of a device on the bus
+            *
+            *   @param  address     7 bit device address
+            *   @param  reg         Register number, 0 ... 255
+            *   @return Returns the last value written to the register
+            */
+            uint8_t hostRegister(uint8_t address, uint8_t reg);
+
+            /**
+            *   @brief  Get the bus counters since the last hostReset()
+            *
+            *   @param  transfers   Returns the number of transfers
+            *   @param  bytes       Returns the number of bytes after the address
+            *   @param  busUS       Returns the microseconds the bus was busy
+            */
+            void hostCounters(uint32_t* transfers, uint32_t* bytes, uint64_t* busUS);
+
+            /**
+            *   @brief  Get the number of transfers started while the bus was still busy, they are dropped
+            *
+            *   @return Returns the number of dropped transfers since the last hostReset()
+            */
+            uint32_t hostOverlaps(void);
+
+            /**
+            *   @brief  Clear the bus counters
+            */
+            void hostReset(void);
+
+        private:
+            /**
+            *   @brief  End the transfer on the bus if its time has passed
+            */
+            void complete(void);
+
+            uint32_t clockHz = 100000;
+            bool busy = false;
+            uint64_t doneUS = 0;
+            uint8_t txAddress = 0;
+            const uint8_t* txBuffer = nullptr;
+            size_t txCount = 0;
+            size_t transferred = 0;
+            uint8_t registers[128][256] = {};
+            uint32_t transfers = 0;
+            uint32_t bytes = 0;
+            uint64_t busUS = 0;
+            uint32_t overlaps = 0;
+    };
+
+    extern IMX_RT1060_I2CMaster Master;  // Pins 18 and 19, the port of Wire
+    extern IMX_RT1060_I2CMaster Master1;  // Pins 17 and 16, the port of Wire1
+    extern IMX_RT1060_I2CMaster Master2;  // Pins 25 and 24, the port of Wire2
+
+#endif  // HOST_IMX_RT1060_I2C_DRIVER_H_
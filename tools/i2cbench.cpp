@@ -0,0 +1,223 @@
+/**
+*   @file   i2cbench.cpp
+*   @brief  Times the I2C burst queue of the controller against the number of servo boards on a PC
+*
+*   Build: g++ -std=gnu++17 -O2 -Ihost -I.. -o i2cbench i2cbench.cpp host/[A-Za-z]*.cpp ../[a-z]*.cpp
+*   Use:   ./i2cbench [frames]
+*
+*   The servo code of the controller runs as is against the fake ports in host/imx_rt1060, which
+*   charge the time each transfer takes at 400 kHz. Every frame stages new ticks for the servos
+*   with setServo() and sends them with queueServos() and serviceServos(), the same calls the
+*   show loop makes. Four patterns are timed for 1 ... MAX_BOARDS boards: every channel with
+*   every board on the Wire port, every other channel, which splits each board into one channel
+*   bursts, one queueServos() per channel, the one transfer per servo the bursts replaced, and
+*   every channel with the boards spread over the I2C_BUSES ports, which are sent at once.
+*   The registers of each board are checked against the staged ticks, a mismatch fails.
+*/
+
+#include "config.h"
+#include "layout.h"
+#include "servo.h"
+#include <SD.h>
+#include <imx_rt1060/imx_rt1060_i2c_driver.h>
+#include <vector>
+
+#define PCA9685_LED0_ON_L 0x06
+
+/**
+*   @brief  Struct for the bus time of one pattern
+*/
+struct result_t {
+    uint32_t transfers;
+    uint32_t bytes;
+    uint64_t busUS;
+    uint64_t frameUS;
+};
+
+IMX_RT1060_I2CMaster* const ports[I2C_BUSES] = {&Master, &Master1, &Master2};
+uint16_t staged[MAX_SERVOS];
+bool failed = false;
+
+/**
+*   @brief  Put a config file with a given number of boards on the card, every servo enabled
+*
+*   @param  boards  Number of boards, 1 ... MAX_BOARDS
+*   @param  spread  ```true``` to put board n on port n % I2C_BUSES and ```false``` for every board on Wire
+*/
+void writeConfig(uint8_t boards, bool spread) {
+    config_t config = {};
+
+    config.version = 2;
+    config.boardCount = boards;
+
+    for (uint8_t b = 0; b < boards; b++) {
+        config.boardBus[b] = spread ? (b % I2C_BUSES) : 0;
+    }
+
+    for (uint8_t s = 0; s < MAX_SERVOS; s++) {
+        conf_servo_t &record = (s < 16) ? config.servosLow[s] : config.servosHigh[s - 16];
+
+        record.enabled = (s < boards * 16);
+        record.pin = s;
+        record.min = 150;
+        record.max = 600;
+        snprintf(record.name, sizeof(record.name), "S%u", s);
+    }
+
+    const uint8_t* bytes = (const uint8_t*)&config;
+    SD.hostWrite("FIG.CFG", std::vector<uint8_t>(bytes, bytes + sizeof(config)));
+}
+
+/**
+*   @brief  Check the registers of every board hold the ticks last staged for its channels
+*
+*   @param  boards  Number of boards
+*/
+void checkRegisters(uint8_t boards) {
+    for (uint8_t pin = 0; pin < boards * 16; pin++) {
+        IMX_RT1060_I2CMaster* port = ports[getBoardBus(pin / 16)];
+        uint8_t address = getBoardAddress(pin / 16);
+        uint8_t reg = PCA9685_LED0_ON_L + ((pin % 16) * 4);
+        uint16_t ticks = port->hostRegister(address, reg + 2) | ((port->hostRegister(address, reg + 3) & 0x0F) << 8);
+
+        if (ticks != staged[pin] && !failed) {
+            printf("Board %u channel %u holds %u ticks instead of %u\n", pin / 16, pin % 16, ticks, staged[pin]);
+            failed = true;
+        }
+    }
+}
+
+/**
+*   @brief  Stage the next ticks for a servo, a sweep that moves every frame
+*
+*   @param  pin     Servo pin
+*   @param  frame   Frame number
+*/
+void stageServo(uint8_t pin, uint32_t frame) {
+    staged[pin] = 150 + ((frame * 7 + pin * 13) % 450);
+    setServo(pin, staged[pin]);
+}
+
+/**
+*   @brief  Time one pattern of staged servos over a number of frames
+*
+*   @param  boards  Number of boards
+*   @param  frames  Number of frames
+*   @param  step    Channels between staged servos, 1 for every channel
+*   @param  single  ```true``` to send each servo with its own queueServos()
+*   @param  spread  ```true``` to spread the boards over the ports
+*   @return Returns the bus time per frame, summed over the ports
+*/
+result_t runPattern(uint8_t boards, uint32_t frames, uint8_t step, bool single, bool spread) {
+    result_t result = {};
+
+    writeConfig(boards, spread);
+    setupServos();
+
+    for (uint8_t pin = 0; pin < boards * 16; pin++) {
+        staged[pin] = getServoCenter(pin);
+    }
+
+    checkRegisters(boards);
+
+    for (IMX_RT1060_I2CMaster* port : ports) {
+        port->hostReset();
+    }
+
+    uint64_t start = hostNow();
+
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint8_t pin = (f % step); pin < boards * 16; pin += step) {
+            stageServo(pin, f);
+
+            if (single) {
+                queueServos();
+
+                while (serviceServos()) {
+                    // One transfer per servo
+                }
+            }
+        }
+
+        if (!single) {
+            queueServos();
+
+            while (serviceServos()) {
+                // Send the frame
+            }
+        }
+
+        checkRegisters(boards);
+    }
+
+    result.frameUS = (hostNow() - start) / frames;
+
+    for (IMX_RT1060_I2CMaster* port : ports) {
+        uint32_t transfers;
+        uint32_t bytes;
+        uint64_t busUS;
+
+        port->hostCounters(&transfers, &bytes, &busUS);
+        result.transfers += transfers;
+        result.bytes += bytes;
+        result.busUS += busUS;
+    }
+
+    result.transfers /= frames;
+    result.bytes /= frames;
+    result.busUS /= frames;
+
+    return result;
+}
+
+/**
+*   @brief  Print the time of one pattern per frame
+*
+*   @param  label   Pattern name
+*   @param  result  Bus time per frame
+*/
+void printResult(const char* label, const result_t &result) {
+    printf("  %-14s %5u transfers %6u bytes %7llu us bus %7llu us frame %5.1f%% of a frame\n", label, result.transfers, result.bytes,
+        (unsigned long long)result.busUS, (unsigned long long)result.frameUS, result.frameUS * 100.0 / (SAMPLE_RATE * 1000.0));
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = (argc > 1) ? strtoul(argv[1], NULL, 10) : 100;
+
+    if (frames == 0) {
+        frames = 1;
+    }
+
+    Serial.hostEcho(false);
+    SD.begin(BUILTIN_SDCARD);
+
+    printf("%u frames of %u ms, 400 kHz ports\n", frames, SAMPLE_RATE);
+
+    result_t first = {};
+
+    for (uint8_t boards = 1; boards <= MAX_BOARDS; boards++) {
+        result_t every = runPattern(boards, frames, 1, false, false);
+        result_t alternate = runPattern(boards, frames, 2, false, false);
+        result_t single = runPattern(boards, frames, 1, true, false);
+        result_t spread = runPattern(boards, frames, 1, false, true);
+
+        if (boards == 1) {
+            first = spread;
+        }
+
+        printf("%u board%s, %u servos\n", boards, (boards > 1) ? "s" : "", boards * 16);
+        printResult("every channel", every);
+        printResult("every other", alternate);
+        printResult("one per servo", single);
+        printResult("spread ports", spread);
+        printf("  bursts save %.0f%% of the bus time of one transfer per servo, spread frames take %.2fx the time of 1 board\n",
+            100.0 - (every.busUS * 100.0 / single.busUS), (double)spread.frameUS / first.frameUS);
+    }
+
+    if (failed) {
+        printf("Board registers do not match the staged ticks\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+/**
+*   @file   i2ctest.cpp
+*   @brief  Checks on a PC that servo output runs on the bus beside the frame loop instead of holding it up
+*
+*   Build: g++ -std=gnu++17 -O2 -Ihost -I.. -o i2ctest i2ctest.cpp host/[A-Za-z]*.cpp ../[a-z]*.cpp
+*   Use:   ./i2ctest [frames]
+*
+*   The servo code of the controller runs as is against the fake masters in host/imx_rt1060,
+*   whose transfers end on the virtual clock while the caller goes on. A frame loop shaped like
+*   runShow() stages every servo of four boards each frame, queues them with queueServos() and
+*   between frames calls serviceServos() and does a slice of other work, the SD refill or the
+*   audio of the controller. Each frame is run once with room to spare and once with a frame
+*   shorter than its bus time. The run fails if serviceServos() ever waits on the bus, a transfer
+*   is started while the bus is busy, or a board does not hold the ticks of the last frame.
+*/
+
+#include "config.h"
+#include "layout.h"
+#include "servo.h"
+#include <SD.h>
+#include <imx_rt1060/imx_rt1060_i2c_driver.h>
+#include <vector>
+
+#define PCA9685_LED0_ON_L 0x06
+#define TEST_BOARDS 4
+#define TEST_WORK_US 20  // Other work in each pass of the frame loop
+#define TEST_CALL_MAX_US 2  // Longest a serviceServos() call may take, one status read
+
+/**
+*   @brief  Struct for what one run of the frame loop measured
+*/
+struct run_t {
+    uint32_t callMaxUS;  // Longest serviceServos() call
+    uint64_t workUS;  // Other work done while the bus was sending
+    uint64_t busUS;  // Time the bus was sending
+    uint32_t overlaps;  // Frames queued while the last one was still on the bus
+};
+
+uint16_t staged[MAX_SERVOS];
+bool failed = false;
+
+/**
+*   @brief  Put a config file with a given number of boards on the card, every servo enabled
+*
+*   @param  boards  Number of boards, 1 ... MAX_BOARDS
+*/
+void writeConfig(uint8_t boards) {
+    config_t config = {};
+
+    config.version = 2;
+    config.boardCount = boards;
+
+    for (uint8_t s = 0; s < boards * 16; s++) {
+        conf_servo_t &record = (s < 16) ? config.servosLow[s] : config.servosHigh[s - 16];
+
+        record.enabled = 1;
+        record.pin = s;
+        record.min = 150;
+        record.max = 600;
+    }
+
+    const uint8_t* bytes = (const uint8_t*)&config;
+    SD.hostWrite("FIG.CFG", std::vector<uint8_t>(bytes, bytes + sizeof(config)));
+}
+
+/**
+*   @brief  Check the registers of every board hold the ticks last staged for its channels
+*
+*   @param  label   Run name for the failure message
+*   @param  frame   Frame number for the failure message
+*/
+void checkRegisters(const char* label, uint32_t frame) {
+    for (uint8_t pin = 0; pin < TEST_BOARDS * 16 && !failed; pin++) {
+        uint8_t address = getBoardAddress(pin / 16);
+        uint8_t reg = PCA9685_LED0_ON_L + ((pin % 16) * 4);
+        uint16_t ticks = Master.hostRegister(address, reg + 2) | ((Master.hostRegister(address, reg + 3) & 0x0F) << 8);
+
+        if (ticks != staged[pin]) {
+            printf("%s: frame %u board %u channel %u holds %u ticks instead of %u\n", label, frame, pin / 16, pin % 16, ticks, staged[pin]);
+            failed = true;
+        }
+    }
+}
+
+/**
+*   @brief  Run the frame loop for a number of frames
+*
+*   @param  label   Run name
+*   @param  frames  Number of frames
+*   @param  frameUS Frame period in microseconds
+*   @return Returns what the run measured
+*/
+run_t runFrames(const char* label, uint32_t frames, uint32_t frameUS) {
+    run_t run = {};
+    uint32_t frame = 0;
+    uint32_t microsPrev = micros() - frameUS;
+    uint32_t transfers;
+    uint32_t bytes;
+
+    Master.hostReset();
+
+    while (frame < frames) {
+        if (micros() - microsPrev >= frameUS) {
+            microsPrev += frameUS;
+
+            if (servosBusy()) {
+                run.overlaps++;
+            } else if (frame > 0) {
+                checkRegisters(label, frame - 1);
+            }
+
+            for (uint8_t pin = 0; pin < TEST_BOARDS * 16; pin++) {
+                staged[pin] = 150 + ((frame * 7 + pin * 13) % 450);
+                setServo(pin, staged[pin]);
+            }
+
+            queueServos();
+            frame++;
+        } else {
+            uint64_t callStart = hostNow();
+            bool busy = serviceServos();
+
+            run.callMaxUS = max(run.callMaxUS, (uint32_t)(hostNow() - callStart));
+
+            hostAdvance(TEST_WORK_US);
+
+            if (busy) {
+                run.workUS += TEST_WORK_US;
+            }
+        }
+    }
+
+    flushServos();
+    checkRegisters(label, frame - 1);
+    Master.hostCounters(&transfers, &bytes, &run.busUS);
+
+    if (run.callMaxUS > TEST_CALL_MAX_US) {
+        printf("%s: serviceServos() held the loop for %u us\n", label, run.callMaxUS);
+        failed = true;
+    }
+
+    if (Master.hostOverlaps() > 0) {
+        printf("%s: %u transfers were started while the bus was busy\n", label, Master.hostOverlaps());
+        failed = true;
+    }
+
+    printf("%-10s %4u us frames | bus %4llu us per frame | loop worked %4llu us per frame while the bus sent | longest serviceServos() %u us | overlapped frames %u\n",
+        label, frameUS, (unsigned long long)(run.busUS / frames), (unsigned long long)(run.workUS / frames), run.callMaxUS, run.overlaps);
+
+    return run;
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = (argc > 1) ? strtoul(argv[1], NULL, 10) : 200;
+
+    if (frames == 0) {
+        frames = 1;
+    }
+
+    Serial.hostEcho(false);
+    SD.begin(BUILTIN_SDCARD);
+    writeConfig(TEST_BOARDS);
+    setupServos();
+
+    run_t room = runFrames("room", frames, SAMPLE_RATE * 1000);
+    run_t overloaded = runFrames("overloaded", frames, room.busUS / (frames * 2));
+
+    // With room to spare the loop keeps most of the bus time for its own work and never overlaps
+    if (room.overlaps > 0 || room.workUS * 2 < room.busUS) {
+        printf("room: the loop waited on the bus instead of working beside it\n");
+        failed = true;
+    }
+
+    if (overloaded.overlaps == 0) {
+        printf("overloaded: no frame was queued over the last one\n");
+        failed = true;
+    }
+
+    if (failed) {
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
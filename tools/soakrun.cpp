@@ -0,0 +1,238 @@
+/**
+*   @file   soakrun.cpp
+*   @brief  Runs the controller's auto-play loop for hours or days on a PC and fails on a soak regression
+*
+*   Build: g++ -std=gnu++17 -O2 -Ihost -I.. -o soakrun soakrun.cpp host/[A-Za-z]*.cpp ../[a-z]*.cpp
+*   Use:   ./soakrun [hours] [fill]
+*
+*   The controller sources run as is against the fakes in host/, with a virtual clock, an
+*   in-memory SD card holding a config, two shows with events and their WAV files, and the
+*   audio interrupt driven from the clock. Every cycle is the loadShow(), playShow() and
+*   startIdle() of the auto-play loop, so the metrics of soak.cpp are taken the same way as
+*   on the controller. The report of printSoak() is printed at the end and the exit code is 1
+*   when isSoakRegressed(), so a run can gate a change.
+*
+*   The waits between frames are skipped in steps of up to SOAK_SKIP_US, so a day of shows
+*   runs in minutes. Timings measured across a wait can read that much long, well inside the
+*   slack of every soak metric.
+*
+*   The card is SOAK_CARD_BYTES and fill is the percent of it other files take per day, logs
+*   or uploads. Shows are rendered at the start and one is rendered again every
+*   SOAK_RENDER_CYCLES, like an edit during the day, so renders written to a card past half full
+*   are scattered and slower to read, and the card slows down the way host/SD.h models it.
+*   A row per hour gives the cycles, the card fill and whether a metric has regressed. Free
+*   heap is not measured on a PC and is left out of the report.
+*/
+
+#include "audio.h"
+#include "config.h"
+#include "events.h"
+#include "idle.h"
+#include "layout.h"
+#include "lipsync.h"
+#include "playlist.h"
+#include "render.h"
+#include "servo.h"
+#include "show.h"
+#include "soak.h"
+#include "sync.h"
+#include "trigger.h"
+#include <SD.h>
+#include <vector>
+
+#define SOAK_SHOWS 2
+#define SOAK_SHOW_MS 3000
+#define SOAK_SERVOS 16
+#define SOAK_WAV_RATE 44100
+#define SOAK_SKIP_US 100  // Longest clock step while the frame loop waits
+#define SOAK_CARD_BYTES (1ULL << 30)
+#define SOAK_RENDER_CYCLES 119  // About every 6 minutes, odd so the shows take turns
+#define SOAK_HOUR_US 3600000000ULL
+
+/**
+*   @brief  Write a little endian value into a file image
+*
+*   @param  data    File image
+*   @param  address Offset of the value
+*   @param  value   Value to write
+*   @param  size    Bytes to write, 1 ... 4
+*/
+void putLE(std::vector<uint8_t> &data, uint32_t address, uint32_t value, uint8_t size) {
+    for (uint8_t i = 0; i < size; i++) {
+        data[address + i] = (value >> (i * 8)) & 0xFF;
+    }
+}
+
+/**
+*   @brief  Put a config file with one board of servos on the card
+*/
+void writeConfig() {
+    config_t config = {};
+
+    config.version = 2;
+    config.boardCount = 1;
+
+    for (uint8_t s = 0; s < SOAK_SERVOS; s++) {
+        config.servosLow[s].enabled = 1;
+        config.servosLow[s].pin = s;
+        config.servosLow[s].min = 150;
+        config.servosLow[s].max = 600;
+        snprintf(config.servosLow[s].name, sizeof(config.servosLow[s].name), "S%u", s);
+    }
+
+    const uint8_t* bytes = (const uint8_t*)&config;
+    SD.hostWrite("FIG.CFG", std::vector<uint8_t>(bytes, bytes + sizeof(config)));
+}
+
+/**
+*   @brief  Put a show file with swept servo tracks and an events chunk on the card
+*
+*   @param  number  Show number, 0 ... 255
+*/
+void writeShow(uint8_t number) {
+    std::vector<uint8_t> data(SHOW_SIZE, 0);
+    char fileName[8];
+
+    for (uint32_t a = 0; a < SHOW_HEADER; a++) {
+        data[a] = 127 + (int)(100 * sin((a + number * 37) / 50.0));
+    }
+
+    data[SHOW_NUMBER] = number;
+    putLE(data, SHOW_MS, SOAK_SHOW_MS, 4);
+    data[SHOW_VERSION_BYTE] = 1;
+    memcpy(&data[SHOW_MAGIC], SHOW_MAGIC_DATA, sizeof(SHOW_MAGIC_DATA));
+    snprintf((char*)&data[SHOW_NAME], 16, "Soak %u", number);
+
+    // One output toggled every half second
+    uint16_t eventCount = SOAK_SHOW_MS / 500;
+    uint32_t chunk = data.size();
+
+    data.resize(chunk + CHUNK_HEADER_SIZE + (eventCount * EVENT_BYTE_SIZE), 0);
+    memcpy(&data[chunk], CHUNK_EVENTS, 4);
+    putLE(data, chunk + 4, eventCount * EVENT_BYTE_SIZE, 4);
+
+    for (uint16_t e = 0; e < eventCount; e++) {
+        uint32_t address = chunk + CHUNK_HEADER_SIZE + (e * EVENT_BYTE_SIZE);
+        putLE(data, address, e * 500, 4);
+        data[address + 4] = 0;
+        data[address + 5] = e & 1;
+    }
+
+    sprintf(fileName, "%03d.ANI", number);
+    SD.hostWrite(fileName, data);
+}
+
+/**
+*   @brief  Put a mono 16 bit WAV file as long as its show on the card
+*
+*   @param  number  Show number, 0 ... 255
+*/
+void writeWav(uint8_t number) {
+    uint32_t samples = ((uint64_t)SOAK_SHOW_MS * SOAK_WAV_RATE) / 1000;
+    std::vector<uint8_t> data(44 + (samples * 2), 0);
+    char fileName[8];
+
+    memcpy(&data[0], "RIFF", 4);
+    putLE(data, 4, data.size() - 8, 4);
+    memcpy(&data[8], "WAVEfmt ", 8);
+    putLE(data, 16, 16, 4);
+    putLE(data, 20, 1, 2);  // PCM
+    putLE(data, 22, 1, 2);  // Mono
+    putLE(data, 24, SOAK_WAV_RATE, 4);
+    putLE(data, 28, SOAK_WAV_RATE * 2, 4);
+    putLE(data, 32, 2, 2);
+    putLE(data, 34, 16, 2);
+    memcpy(&data[36], "data", 4);
+    putLE(data, 40, samples * 2, 4);
+
+    for (uint32_t i = 0; i < samples; i++) {
+        putLE(data, 44 + (i * 2), (uint16_t)(int16_t)(8000 * sin(i * 2 * M_PI * 440 / SOAK_WAV_RATE)), 2);
+    }
+
+    sprintf(fileName, "%03d.WAV", number);
+    SD.hostWrite(fileName, data);
+}
+
+/**
+*   @brief  Load a show, print a failure if it does not load
+*
+*   @param  number  Show number, 0 ... 255
+*   @param  cycle   Cycle number for the failure message
+*   @return ```true``` if the show loaded and ```false``` if not
+*/
+bool loadSoakShow(uint8_t number, uint32_t cycle) {
+    if (!showExists(number) || !loadShow(number)) {
+        printf("Show %u did not load on cycle %u\n", number, cycle);
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    uint32_t hours = (argc > 1) ? strtoul(argv[1], NULL, 10) : 24;
+    uint32_t fill = (argc > 2) ? strtoul(argv[2], NULL, 10) : 0;
+    uint64_t filled = 0;
+    uint32_t cycle = 0;
+    uint32_t hour = 0;
+
+    writeConfig();
+
+    for (uint8_t n = 1; n <= SOAK_SHOWS; n++) {
+        writeShow(n);
+        writeWav(n);
+    }
+
+    // The same order as setup() on the controller
+    Serial.hostEcho(false);
+    hostSkipIdle(SOAK_SKIP_US);
+    SD.hostCapacity(SOAK_CARD_BYTES);
+    setupAudio();
+    SD.begin(BUILTIN_SDCARD);
+    setupServos();
+    setupOutputs();
+    setupLipsync();
+    setupSync();
+    setupTrigger();
+    scanShows();
+    loadPlaylist();
+
+    for (uint8_t n = 1; n <= SOAK_SHOWS; n++) {
+        if (!loadSoakShow(n, 0) || !renderShow()) {
+            printf("Show %u did not render\n", n);
+            return 1;
+        }
+    }
+
+    while (hostNow() < hours * SOAK_HOUR_US) {
+        uint8_t number = 1 + (cycle % SOAK_SHOWS);
+
+        if (!loadSoakShow(number, cycle)) {
+            return 1;
+        }
+
+        // A full card can not take the render, the old one is kept like on the controller
+        if (cycle > 0 && cycle % SOAK_RENDER_CYCLES == 0) {
+            renderShow();
+        }
+
+        playShow();
+        startIdle();
+        cycle++;
+
+        // Other files take their share of the card as the day goes on
+        uint64_t due = ((((SOAK_CARD_BYTES / 100) * fill) / (24 * 3600)) * hostNow()) / 1000000;
+        SD.hostFill(due - filled);
+        filled = due;
+
+        if (hostNow() >= (hour + 1) * SOAK_HOUR_US) {
+            hour = hostNow() / SOAK_HOUR_US;
+            printf("%5u h | cycles %7u | card %3u%% full | %s\n", hour, cycle, SD.hostFillPercent(), isSoakRegressed() ? "regressed" : "ok");
+        }
+    }
+
+    Serial.hostEcho(true);
+    printSoak();
+
+    return isSoakRegressed() ? 1 : 0;
+}
@@ -0,0 +1,336 @@
+/**
+*   @file   syncsim.cpp
+*   @brief  Runs a master and several followers of the timecode code on a PC and prints how they lock
+*
+*   Build: g++ -std=gnu++17 -O2 -Ihost -I.. -o syncsim syncsim.cpp host/Arduino.cpp
+*   Use:   ./syncsim [seconds]
+*
+*   ../sync.cpp is built once per controller, each copy in its own namespace with its own
+*   Serial1, micros() and getSyncConfig(). Timecodes from the master go to every follower over
+*   a pipe once their time on the wire has passed. Each controller has a clock that runs fast
+*   or slow of the host virtual clock and starts its show at its own time, then runs the frame
+*   loop of runShow() with sendSync(), serviceSync() and lockSync().
+*
+*   Every second a row gives the true offset of each follower to the master, from the virtual
+*   times both output the same frame, and the slew it runs its frames with. The exit code is 1
+*   if a follower ends more than SYNC_LOCK_US from the master.
+*/
+
+#include "config.h"
+#include "layout.h"
+#include "show.h"
+#include "sync.h"
+#include <deque>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+#define SYNC_NODES 4
+#define SYNC_LOCK_US 500  // Largest offset a follower may end the run with
+#define FRAME_US (SAMPLE_RATE * 1000)
+
+/**
+*   @brief  Struct for the clock and start of a simulated controller
+*/
+struct node_t {
+    uint8_t role;
+    int32_t ppm;  // Clock error, positive runs fast
+    uint32_t bootUS;  // micros() at virtual time 0
+    uint32_t startUS;  // Virtual time the show starts
+};
+
+const node_t nodes[SYNC_NODES] = {
+    {SYNC_MASTER, 0, 0, 0},
+    {SYNC_FOLLOWER, 80, 123456, 25000},  // Starts a little late, clock fast
+    {SYNC_FOLLOWER, -120, 987654, 3000},  // Starts close, clock slow
+    {SYNC_FOLLOWER, 40, 55555, 900000},  // Starts too late to slew, seeks
+};
+
+int pipes[SYNC_NODES][2];
+
+/**
+*   @brief  Struct for a byte on its way from the master, held until its time on the wire has passed
+*/
+struct wireByte_t {
+    uint64_t due;
+    uint8_t value;
+};
+
+std::deque<wireByte_t> wire;
+
+/**
+*   @brief  Class for the timecode port of one controller, the master writes and the followers read a pipe
+*/
+class SyncPort : public Stream {
+    public:
+        explicit SyncPort(uint8_t node) : node(node) {}
+
+        int available(void) override {
+            return pending;
+        }
+
+        int read(void) override {
+            uint8_t value;
+
+            if (pending == 0 || ::read(pipes[node][0], &value, 1) != 1) {
+                return -1;
+            }
+
+            pending--;
+            return value;
+        }
+
+        size_t write(uint8_t value) override {
+            // 10 bits per byte at the timecode baud rate, one byte after the other
+            uint64_t start = wire.empty() ? hostNow() : max(hostNow(), wire.back().due);
+            wire.push_back({start + (10 * 1000000ULL / 115200), value});
+            return 1;
+        }
+
+        size_t write(const uint8_t* data, size_t size) override {
+            for (size_t i = 0; i < size; i++) {
+                write(data[i]);
+            }
+
+            return size;
+        }
+
+        uint32_t pending = 0;
+
+    private:
+        uint8_t node;
+};
+
+/**
+*   @brief  Get the local clock of a controller
+*
+*   @param  node    Controller number
+*   @return Returns the microseconds of its micros()
+*/
+uint32_t nodeMicros(uint8_t node) {
+    int64_t now = hostNow();
+    return (uint32_t)(nodes[node].bootUS + now + ((now * nodes[node].ppm) / 1000000));
+}
+
+// One copy of the timecode code per controller, each sees only its own port, clock and role
+namespace node0 {
+    SyncPort Serial1(0);
+    uint32_t micros(void) { return nodeMicros(0); }
+    uint8_t getSyncConfig(void) { return nodes[0].role; }
+    #include "sync.cpp"
+}
+
+namespace node1 {
+    SyncPort Serial1(1);
+    uint32_t micros(void) { return nodeMicros(1); }
+    uint8_t getSyncConfig(void) { return nodes[1].role; }
+    #include "sync.cpp"
+}
+
+namespace node2 {
+    SyncPort Serial1(2);
+    uint32_t micros(void) { return nodeMicros(2); }
+    uint8_t getSyncConfig(void) { return nodes[2].role; }
+    #include "sync.cpp"
+}
+
+namespace node3 {
+    SyncPort Serial1(3);
+    uint32_t micros(void) { return nodeMicros(3); }
+    uint8_t getSyncConfig(void) { return nodes[3].role; }
+    #include "sync.cpp"
+}
+
+/**
+*   @brief  Struct for the timecode functions and counters of one copy of sync.cpp
+*/
+struct syncApi_t {
+    SyncPort* port;
+    uint32_t (*micros)(void);
+    void (*setupSync)(void);
+    void (*resetSync)(void);
+    void (*sendSync)(uint8_t, uint32_t);
+    bool (*serviceSync)(void);
+    uint8_t (*getSyncShow)(void);
+    uint32_t (*getSyncMS)(void);
+    int32_t (*lockSync)(uint32_t, uint32_t);
+    bool (*syncJumpNeeded)(void);
+    int32_t* syncOffset;
+    uint32_t* syncPackets;
+    uint32_t* syncJumps;
+};
+
+#define SYNC_API(NODE) {&NODE::Serial1, NODE::micros, NODE::setupSync, NODE::resetSync, NODE::sendSync, NODE::serviceSync, \
+    NODE::getSyncShow, NODE::getSyncMS, NODE::lockSync, NODE::syncJumpNeeded, &NODE::syncOffset, &NODE::syncPackets, &NODE::syncJumps}
+
+const syncApi_t api[SYNC_NODES] = {SYNC_API(node0), SYNC_API(node1), SYNC_API(node2), SYNC_API(node3)};
+
+/**
+*   @brief  Struct for the frame loop of one controller, the same state runShow() keeps
+*/
+struct player_t {
+    bool playing;
+    uint32_t frame;
+    uint32_t microsPrev;
+    int32_t frameCorrection;
+    int32_t slewMax;
+    int32_t trueOffset;  // Virtual microseconds behind the master at the last frame, negative when ahead
+    int32_t trueOffsetMax;  // Largest after the first second
+};
+
+player_t players[SYNC_NODES] = {};
+std::vector<uint64_t> frameTimes[SYNC_NODES];  // Virtual time each frame was output, 0 if not yet
+
+/**
+*   @brief  Move the timecode bytes whose time on the wire has passed into every follower's pipe
+*/
+void pumpWire() {
+    while (!wire.empty() && wire.front().due <= hostNow()) {
+        uint8_t value = wire.front().value;
+        wire.pop_front();
+
+        for (uint8_t n = 0; n < SYNC_NODES; n++) {
+            if (nodes[n].role == SYNC_FOLLOWER && ::write(pipes[n][1], &value, 1) == 1) {
+                api[n].port->pending++;
+            }
+        }
+    }
+}
+
+/**
+*   @brief  Record the virtual time a controller output a frame and update the true offsets it completes
+*
+*   @param  n       Controller number
+*   @param  frame   Frame number
+*/
+void recordFrame(uint8_t n, uint32_t frame) {
+    frameTimes[n][frame] = hostNow();
+
+    // The offset is known once the master and the follower have both output the frame, whichever is first
+    for (uint8_t f = 1; f < SYNC_NODES; f++) {
+        if ((n != 0 && f != n) || frameTimes[0][frame] == 0 || frameTimes[f][frame] == 0) {
+            continue;
+        }
+
+        player_t &p = players[f];
+        p.trueOffset = (int32_t)(frameTimes[f][frame] - frameTimes[0][frame]);
+
+        if (hostNow() > 1000000 + nodes[f].startUS) {
+            p.trueOffsetMax = max(p.trueOffsetMax, abs(p.trueOffset));
+        }
+    }
+}
+
+/**
+*   @brief  Run one pass of the frame loop of a controller
+*
+*   @param  n           Controller number
+*   @param  maxFrames   Frames in the show
+*/
+void stepPlayer(uint8_t n, uint32_t maxFrames) {
+    player_t &p = players[n];
+    const syncApi_t &s = api[n];
+
+    if (!p.playing) {
+        if (hostNow() < nodes[n].startUS) {
+            // Waiting followers keep reading timecodes like the idle loop does, so none are stale at the start
+            s.serviceSync();
+            return;
+        }
+
+        s.resetSync();
+        p.playing = true;
+        p.microsPrev = s.micros() - FRAME_US;
+    }
+
+    if (p.frame >= maxFrames) {
+        return;
+    }
+
+    uint32_t microsNow = s.micros();
+    uint32_t frameUS = FRAME_US + p.frameCorrection;
+
+    if (microsNow - p.microsPrev >= frameUS) {
+        uint32_t frameLate = microsNow - p.microsPrev - frameUS;
+        p.microsPrev = (frameLate < frameUS) ? (p.microsPrev + frameUS) : microsNow;
+
+        s.sendSync(1, p.frame);
+        recordFrame(n, p.frame);
+        p.frame++;
+    } else if (s.serviceSync() && s.getSyncShow() == 1) {
+        p.frameCorrection = s.lockSync(p.frame - 1, p.microsPrev);
+        p.slewMax = max(p.slewMax, abs(p.frameCorrection));
+
+        if (s.syncJumpNeeded()) {
+            p.frame = s.getSyncMS() / SAMPLE_RATE;
+            p.microsPrev = s.micros() - FRAME_US;
+        }
+    }
+}
+
+/**
+*   @brief  Print the true offset and slew of every follower
+*/
+void printRow() {
+    printf("%5llu s", (unsigned long long)(hostNow() / 1000000));
+
+    for (uint8_t n = 1; n < SYNC_NODES; n++) {
+        printf(" | %8d us %5d us", players[n].trueOffset, players[n].frameCorrection);
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    uint32_t seconds = (argc > 1) ? strtoul(argv[1], NULL, 10) : 20;
+    uint32_t maxFrames = (seconds * 1000) / SAMPLE_RATE;
+    bool locked = true;
+
+    for (uint8_t n = 0; n < SYNC_NODES; n++) {
+        if (pipe(pipes[n]) != 0) {
+            printf("Error opening a pipe\n");
+            return 1;
+        }
+
+        fcntl(pipes[n][0], F_SETFL, O_NONBLOCK);
+        frameTimes[n].assign(maxFrames, 0);
+        api[n].setupSync();
+    }
+
+    printf("Followers: offset to the master and frame slew\n  time");
+
+    for (uint8_t n = 1; n < SYNC_NODES; n++) {
+        printf(" | %+4d ppm, starts %4u ms", nodes[n].ppm, nodes[n].startUS / 1000);
+    }
+
+    printf("\n");
+
+    while (hostNow() < ((uint64_t)seconds * 1000000) + nodes[SYNC_NODES - 1].startUS) {
+        hostAdvance(1);
+        pumpWire();
+
+        for (uint8_t n = 0; n < SYNC_NODES; n++) {
+            stepPlayer(n, maxFrames);
+        }
+
+        if (hostNow() % 1000000 == 0) {
+            printRow();
+        }
+    }
+
+    for (uint8_t n = 1; n < SYNC_NODES; n++) {
+        printf("Follower %u: timecodes %u | jumps %u | measured offset %d us | true offset %d us | max after its first second %d us | max slew %d us\n",
+            n, *api[n].syncPackets, *api[n].syncJumps, *api[n].syncOffset, players[n].trueOffset, players[n].trueOffsetMax, players[n].slewMax);
+
+        if (abs(players[n].trueOffset) > SYNC_LOCK_US) {
+            locked = false;
+        }
+    }
+
+    if (!locked) {
+        printf("A follower did not lock to the master\n");
+        return 1;
+    }
+
+    return 0;
+}
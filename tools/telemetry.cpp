@@ -0,0 +1,164 @@
+/**
+*   @file   telemetry.cpp
+*   @brief  Decodes the controller's binary telemetry stream to CSV on a PC
+*
+*   Build: g++ -std=c++11 -O2 -o telemetry telemetry.cpp
+*   Use:   stty -F /dev/ttyACM0 raw && ./telemetry /dev/ttyACM0 > figure.csv
+*
+*   Menu text on the same port is skipped, packets are found by their sync bytes
+*   and checked with their length and xor. A packet that fails its check is rescanned
+*   from the byte after its sync bytes, so a false sync in the text cannot eat a real packet.
+*   Frames played from the render cache leave the value and filtered columns empty.
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#define TELEMETRY_SYNC_0 0xA7
+#define TELEMETRY_SYNC_1 0x7E
+#define TELEMETRY_FRAME 0x01
+#define TELEMETRY_FRAME_RENDERED 0x02
+#define TELEMETRY_HEADER_SIZE 14
+#define TELEMETRY_SERVO_SIZE 4
+
+uint32_t readLE(const uint8_t* data, uint8_t size) {
+    uint32_t value = 0;
+
+    for (uint8_t b = size; b > 0; b--) {
+        value = (value << 8) + data[b - 1];
+    }
+
+    return value;
+}
+
+/**
+*   @brief  Get the next byte, bytes put back by a failed packet come before the file
+*
+*   @param  in      File to read
+*   @param  pending Bytes to read again
+*   @return Returns the byte or EOF
+*/
+int nextByte(FILE* in, std::deque<uint8_t> &pending) {
+    if (pending.empty()) {
+        return fgetc(in);
+    }
+
+    uint8_t value = pending.front();
+    pending.pop_front();
+
+    return value;
+}
+
+/**
+*   @brief  Read bytes into a packet through nextByte()
+*
+*   @param  in      File to read
+*   @param  pending Bytes to read again
+*   @param  packet  Packet to append to
+*   @param  count   Number of bytes to read
+*   @return Returns ```true``` if every byte was read and ```false``` at the end of the file
+*/
+bool readBytes(FILE* in, std::deque<uint8_t> &pending, std::vector<uint8_t> &packet, size_t count) {
+    for (size_t b = 0; b < count; b++) {
+        int c = nextByte(in, pending);
+
+        if (c == EOF) {
+            return false;
+        }
+
+        packet.push_back(c);
+    }
+
+    return true;
+}
+
+/**
+*   @brief  Print one checked frame packet as CSV, one row per servo
+*
+*   @param  packet  Packet from the type byte on
+*/
+void printFrame(const std::vector<uint8_t> &packet) {
+    // The packet starts after the 2 sync bytes
+    const uint8_t* p = packet.data();
+    uint32_t frame = readLE(p + 3, 4);
+    uint32_t lateUS = readLE(p + 7, 2);
+    uint32_t computeUS = readLE(p + 9, 2);
+    uint8_t servoCount = p[11];
+    bool rendered = (p[0] == TELEMETRY_FRAME_RENDERED);
+
+    for (uint8_t s = 0; s < servoCount; s++) {
+        const uint8_t* servo = p + (TELEMETRY_HEADER_SIZE - 2) + (s * TELEMETRY_SERVO_SIZE);
+
+        if (rendered) {
+            printf("%u,%u,%u,%u,%u,,\n", frame, lateUS, computeUS, s, readLE(servo, 2));
+        } else {
+            printf("%u,%u,%u,%u,%u,%u,%u\n", frame, lateUS, computeUS, s, readLE(servo, 2), servo[2], servo[3]);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    FILE* in = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+
+    if (in == NULL) {
+        fprintf(stderr, "Error opening: %s\n", argv[1]);
+        return 1;
+    }
+
+    uint32_t good = 0;
+    uint32_t bad = 0;
+    std::deque<uint8_t> pending;
+    int previous = -1;
+    int c;
+
+    printf("frame,late_us,compute_us,servo,ticks,value,filtered\n");
+
+    while ((c = nextByte(in, pending)) != EOF) {
+        if (previous != TELEMETRY_SYNC_0 || c != TELEMETRY_SYNC_1) {
+            previous = c;
+            continue;
+        }
+
+        previous = -1;
+
+        // Type and length, then the rest of the packet
+        std::vector<uint8_t> packet;
+        bool valid = readBytes(in, pending, packet, 3);
+        uint16_t length = valid ? readLE(&packet[1], 2) : 0;
+
+        valid = valid && (packet[0] == TELEMETRY_FRAME || packet[0] == TELEMETRY_FRAME_RENDERED) &&
+            length >= TELEMETRY_HEADER_SIZE + 1 && length <= TELEMETRY_HEADER_SIZE + (255 * TELEMETRY_SERVO_SIZE) + 1;
+        valid = valid && readBytes(in, pending, packet, length - 5);
+
+        if (valid) {
+            uint8_t check = 0;
+
+            for (size_t b = 0; b + 1 < packet.size(); b++) {
+                check ^= packet[b];
+            }
+
+            uint8_t servoCount = packet[TELEMETRY_HEADER_SIZE - 3];
+            valid = (check == packet.back() && length == TELEMETRY_HEADER_SIZE + (servoCount * TELEMETRY_SERVO_SIZE) + 1);
+        }
+
+        if (!valid) {
+            // A false sync in menu text, scan again from the byte after it
+            pending.insert(pending.begin(), packet.begin(), packet.end());
+            bad++;
+            continue;
+        }
+
+        printFrame(packet);
+        good++;
+    }
+
+    fprintf(stderr, "Packets: %u | Bad: %u\n", good, bad);
+
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+*   @file   trigger.cpp
+*   @brief  Functions for starting a show on an external cue
+*
+*   The show data, render and first audio buffers are loaded before the edge and the
+*   idle motion is held so it can not change the primed servo state or hold the bus.
+*   The interrupt starts the cued audio, which is heard from the next audio update up
+*   to one 128 sample block (~2.9ms) later, and the main loop only sends the first frame.
+*   Over serial, digits and a newline select a show and 't' triggers it.
+*/
+
+#include "trigger.h"
+#include "audio.h"
+#include "config.h"
+#include "idle.h"
+#include "sdio.h"
+#include "servo.h"
+#include "show.h"
+#include "timing.h"
+
+trigger_t triggerSettings;
+uint8_t triggerAttachedPin = 0xFF;
+volatile bool triggerFired = false;
+volatile bool triggerArmed = false;
+volatile uint32_t triggerUS = 0;
+bool triggerPlaying = false;
+int16_t armedShow = -1;
+uint8_t serialShow = 0;
+uint16_t serialDigits = 0;
+bool serialTyping = false;
+
+void triggerISR() {
+    if (triggerFired) {
+        return;
+    }
+
+    triggerUS = micros();
+    triggerFired = true;
+
+    if (triggerArmed) {
+        triggerArmed = false;
+        startAudio();
+    }
+}
+
+void setupTrigger() {
+    triggerSettings = getTriggerData();
+
+    if (triggerAttachedPin != 0xFF) {
+        detachInterrupt(digitalPinToInterrupt(triggerAttachedPin));
+        triggerAttachedPin = 0xFF;
+    }
+
+    for (uint8_t b = 0; b < triggerSettings.selectBits; b++) {
+        pinMode(triggerSettings.selectPin + b, INPUT_PULLUP);
+    }
+
+    if (triggerSettings.mode == TRIGGER_OFF) {
+        return;
+    }
+
+    pinMode(triggerSettings.pin, (triggerSettings.mode == TRIGGER_RISING) ? INPUT_PULLDOWN : INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(triggerSettings.pin), triggerISR, (triggerSettings.mode == TRIGGER_RISING) ? RISING : FALLING);
+    triggerAttachedPin = triggerSettings.pin;
+}
+
+bool isTriggerMode() {
+    return triggerSettings.mode != TRIGGER_OFF;
+}
+
+uint8_t getSelectedShow() {
+    if (triggerSettings.selectBits == 0) {
+        return serialShow;
+    }
+
+    uint8_t number = 0;
+
+    for (uint8_t b = 0; b < triggerSettings.selectBits; b++) {
+        if (digitalRead(triggerSettings.selectPin + b) == LOW) {
+            number |= (1 << b);
+        }
+    }
+
+    return number;
+}
+
+void serviceTriggerSerial() {
+    while (Serial.available() > 0) {
+        char c = Serial.read();
+
+        if (c >= '0' && c <= '9') {
+            serialDigits = min((serialDigits * 10) + (c - '0'), 255);
+            serialTyping = true;
+        } else if ((c == '\n' || c == '\r') && serialTyping) {
+            serialShow = serialDigits;
+            serialDigits = 0;
+            serialTyping = false;
+        } else if (c == 't') {
+            fireTrigger();
+        }
+    }
+}
+
+void triggerShow() {
+    uint8_t number = getSelectedShow();
+
+    serviceTriggerSerial();
+
+    if (number != armedShow) {
+        armedShow = -1;
+
+        if (!showExists(number) || !loadShow(number)) {
+            delay(10);
+            return;
+        }
+
+        armedShow = number;
+    }
+
+    // Idle frames would run the servo filters from the primed show state and queue bursts the first frame waits on
+    stopIdle();
+    armShow(0);
+
+    // An edge while arming, a retrigger, starts the audio here instead of in the interrupt
+    noInterrupts();
+
+    if (triggerFired) {
+        startAudio();
+    } else {
+        triggerArmed = true;
+    }
+
+    interrupts();
+
+    while (!triggerFired) {
+        serviceTriggerSerial();
+        serviceServos();
+        serviceIO();
+
+        if (getSelectedShow() != armedShow) {
+            triggerArmed = false;
+            stopAudio();
+            return;
+        }
+    }
+
+    uint32_t edgeUS = triggerUS;
+    triggerFired = false;
+    triggerPlaying = true;
+    runShow();
+    triggerPlaying = false;
+
+    uint32_t audioUS = getAudioStartUS();
+    recordTriggerLatency(getFirstFrameUS() - edgeUS, (audioUS != 0) ? audioUS - edgeUS : 0);
+
+    if (!triggerSettings.retrigger) {
+        triggerFired = false;
+    }
+}
+
+void fireTrigger() {
+    noInterrupts();
+    triggerISR();
+    interrupts();
+}
+
+bool isRetriggered() {
+    return triggerPlaying && triggerSettings.retrigger && triggerFired;
+}
@@ -0,0 +1,55 @@
+/**
+*   @file   trigger.h
+*   @brief  Functions for starting a show on an external cue
+*/
+
+#ifndef TRIGGER_H_
+    #define TRIGGER_H_
+
+    #include <Arduino.h>
+
+    #define TRIGGER_OFF 0
+    #define TRIGGER_RISING 1
+    #define TRIGGER_FALLING 2
+
+    /**
+    *   @brief  Struct for the trigger settings
+    */
+    struct trigger_t {
+        uint8_t mode;  // TRIGGER_OFF | TRIGGER_RISING | TRIGGER_FALLING
+        uint8_t pin;
+        uint8_t retrigger;  // 0 ignored while playing | 1 restarts the show
+        uint8_t selectPin;  // First of selectBits consecutive pins, active low
+        uint8_t selectBits;  // 0 the show is selected over serial
+    };
+
+    /**
+    *   @brief  Setup the trigger and show select pins from the config file
+    */
+    void setupTrigger(void);
+
+    /**
+    *   @brief  Check if shows are started by the trigger instead of auto play
+    *
+    *   @return ```true``` if the trigger is enabled and ```false``` if not
+    */
+    bool isTriggerMode(void);
+
+    /**
+    *   @brief  Arm the selected show, wait for the trigger and play the show
+    */
+    void triggerShow(void);
+
+    /**
+    *   @brief  Check if the playing show should stop because it was triggered again
+    *
+    *   @return ```true``` if a retrigger restarts the show and there has been one, ```false``` if not
+    */
+    bool isRetriggered(void);
+
+    /**
+    *   @brief  Trigger from software, the same as an edge on the trigger pin
+    */
+    void fireTrigger(void);
+
+#endif  // TRIGGER_H_
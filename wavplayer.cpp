@@ -0,0 +1,270 @@
+/**
+*   @file   wavplayer.cpp
+*   @brief  WAV player whose SD reads are done from the main loop instead of the audio interrupt
+*/
+
+#include "wavplayer.h"
+
+#define WAV_RING_MASK (WAV_RING_SAMPLES - 1)
+
+uint32_t readLE(const uint8_t* data, uint8_t size) {
+    uint32_t value = 0;
+
+    for (uint8_t b = size; b > 0; b--) {
+        value = (value << 8) + data[b - 1];
+    }
+
+    return value;
+}
+
+bool openWavData(File &file, uint8_t* channels, uint32_t* dataSize) {
+    uint8_t header[16];
+
+    if (file.read(header, 12) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    bool format = false;
+
+    while (file.read(header, 8) == 8) {
+        uint32_t size = readLE(header + 4, 4);
+
+        if (memcmp(header, "fmt ", 4) == 0 && size >= 16) {
+            if (file.read(header, 16) != 16) {
+                return false;
+            }
+
+            *channels = readLE(header + 2, 2);
+            format = (readLE(header, 2) == 1) && (*channels == 1 || *channels == 2) &&
+                (readLE(header + 4, 4) == WAV_SAMPLE_RATE) && (readLE(header + 14, 2) == 16);
+
+            file.seek(file.position() + (size - 16) + (size & 1));
+        } else if (memcmp(header, "data", 4) == 0) {
+            *dataSize = size;
+            return format;
+        } else {
+            file.seek(file.position() + size + (size & 1));
+        }
+    }
+
+    return false;
+}
+
+bool AudioPlayShowWav::play(const char* fileName, uint32_t startMillis) {
+    if (!cue(fileName, startMillis)) {
+        return false;
+    }
+
+    start();
+
+    return true;
+}
+
+bool AudioPlayShowWav::cue(const char* fileName, uint32_t startMillis) {
+    stop();
+
+    wavFile = SD.open(fileName);
+
+    if (!wavFile) {
+        return false;
+    }
+
+    if (!openWavData(wavFile, &channels, &dataSize)) {
+        wavFile.close();
+        return false;
+    }
+
+    // PCM has a fixed byte rate, so seeking is a single file seek from the start of the data
+    uint32_t startSamples = ((uint64_t)startMillis * WAV_SAMPLE_RATE) / 1000;
+    uint32_t skip = min((uint64_t)startSamples * channels * 2, (uint64_t)dataSize);
+    wavFile.seek(wavFile.position() + skip);
+
+    __disable_irq();
+    readPos = 0;
+    writePos = 0;
+    samplesPlayed = startSamples;
+    underrunCount = 0;
+    dataRemaining = dataSize - skip;
+    oddByte = 0;
+    endOfData = false;
+    firstBlockMicros = 0;
+    cued = true;
+    __enable_irq();
+
+    return true;
+}
+
+void AudioPlayShowWav::start() {
+    if (cued) {
+        cued = false;
+        playing = true;
+    }
+}
+
+void AudioPlayShowWav::pause() {
+    if (playing) {
+        playing = false;
+        cued = true;
+    }
+}
+
+uint32_t AudioPlayShowWav::startMicros() {
+    return firstBlockMicros;
+}
+
+void AudioPlayShowWav::stop() {
+    playing = false;
+    cued = false;
+    firstBlockMicros = 0;
+
+    if (wavFile) {
+        wavFile.close();
+    }
+}
+
+uint16_t AudioPlayShowWav::refill(uint16_t maxSectors) {
+    uint16_t sectors = 0;
+
+    if (!wavFile) {
+        return 0;
+    }
+
+    if (!playing && !cued) {
+        wavFile.close();
+        return 0;
+    }
+
+    // A read may come back short of a sector, so each one is limited to the free bytes and ends at the wrap
+    while (sectors < maxSectors && dataRemaining > 0 && (WAV_RING_SAMPLES - (writePos - readPos)) >= 256) {
+        uint32_t room = ((WAV_RING_SAMPLES - (writePos - readPos)) * 2) - oddByte;
+        uint32_t contiguous = ((WAV_RING_SAMPLES - (writePos & WAV_RING_MASK)) * 2) - oddByte;
+        uint16_t bytes = min(min(dataRemaining, (uint32_t)512), min(room, contiguous));
+        int count = wavFile.read((uint8_t*)ring + ((writePos & WAV_RING_MASK) * 2) + oddByte, bytes);
+
+        if (count <= 0) {
+            dataRemaining = 0;
+            break;
+        }
+
+        // An odd byte stays in the ring past writePos until the next read brings the rest of its sample
+        uint32_t total = oddByte + count;
+        writePos += total / 2;
+        oddByte = total & 1;
+        dataRemaining -= count;
+        sectors++;
+    }
+
+    if (dataRemaining == 0) {
+        endOfData = true;
+    }
+
+    return sectors;
+}
+
+bool AudioPlayShowWav::isPlaying() {
+    return playing;
+}
+
+uint32_t AudioPlayShowWav::lengthMillis() {
+    return ((uint64_t)dataSize * 1000) / (WAV_SAMPLE_RATE * channels * 2);
+}
+
+uint32_t AudioPlayShowWav::positionMillis() {
+    return ((uint64_t)samplesPlayed * 1000) / WAV_SAMPLE_RATE;
+}
+
+uint32_t AudioPlayShowWav::bufferedMillis() {
+    return ((writePos - readPos) * 1000) / (WAV_SAMPLE_RATE * channels);
+}
+
+bool AudioPlayShowWav::peek(uint32_t aheadSamples, int16_t* mono, uint16_t count) {
+    uint32_t samples = count * channels;
+
+    if (!playing || (writePos - readPos) < samples) {
+        return false;
+    }
+
+    uint32_t start = readPos + (aheadSamples * channels);
+
+    if (start + samples > writePos) {
+        start = writePos - samples;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (channels == 2) {
+            mono[i] = (ring[(start + (i * 2)) & WAV_RING_MASK] + ring[(start + (i * 2) + 1) & WAV_RING_MASK]) / 2;
+        } else {
+            mono[i] = ring[(start + i) & WAV_RING_MASK];
+        }
+    }
+
+    return true;
+}
+
+uint32_t AudioPlayShowWav::underruns() {
+    return underrunCount;
+}
+
+void AudioPlayShowWav::update() {
+    if (!playing) {
+        return;
+    }
+
+    uint32_t blockSamples = AUDIO_BLOCK_SAMPLES * channels;
+    uint32_t available = writePos - readPos;
+
+    if (available < blockSamples && !endOfData) {
+        underrunCount++;
+        return;
+    }
+
+    if (available == 0) {
+        playing = false;
+        return;
+    }
+
+    audio_block_t* left = allocate();
+    audio_block_t* right = (channels == 2) ? allocate() : NULL;
+
+    if (left == NULL || (channels == 2 && right == NULL)) {
+        if (left) {
+            release(left);
+        }
+
+        if (right) {
+            release(right);
+        }
+
+        underrunCount++;
+        return;
+    }
+
+    uint32_t pos = readPos;
+
+    for (uint8_t i = 0; i < AUDIO_BLOCK_SAMPLES; i++) {
+        bool valid = (pos - readPos) < available;
+
+        left->data[i] = valid ? ring[pos & WAV_RING_MASK] : 0;
+        pos++;
+
+        if (channels == 2) {
+            right->data[i] = valid ? ring[pos & WAV_RING_MASK] : 0;
+            pos++;
+        }
+    }
+
+    readPos = readPos + min(available, blockSamples);
+    samplesPlayed = samplesPlayed + AUDIO_BLOCK_SAMPLES;
+
+    transmit(left, 0);
+    transmit(channels == 2 ? right : left, 1);
+    release(left);
+
+    if (firstBlockMicros == 0) {
+        firstBlockMicros = micros();
+    }
+
+    if (right) {
+        release(right);
+    }
+}
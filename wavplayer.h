@@ -0,0 +1,149 @@
+/**
+*   @file   wavplayer.h
+*   @brief  WAV player whose SD reads are done from the main loop instead of the audio interrupt
+*/
+
+#ifndef WAVPLAYER_H_
+    #define WAVPLAYER_H_
+
+    #include <Arduino.h>
+    #include <Audio.h>
+    #include <SD.h>
+
+    #define WAV_RING_SAMPLES 8192  // 16 bit samples, ~93ms of 44.1kHz stereo, power of 2 and a whole number of sectors
+    #define WAV_SAMPLE_RATE 44100
+
+    /**
+    *   @brief  Read a WAV header and leave the file at the start of the sample data
+    *
+    *   @param  file        Open WAV file positioned at the start
+    *   @param  channels    Returns the number of channels, 1 ... 2
+    *   @param  dataSize    Returns the size of the sample data in bytes
+    *   @return ```true``` if the file is 16-bit PCM 44.1kHz mono or stereo and ```false``` if not
+    */
+    bool openWavData(File &file, uint8_t* channels, uint32_t* dataSize);
+
+    /**
+    *   @brief  Plays a 16-bit PCM 44.1kHz mono or stereo WAV file from a ring buffer
+    *
+    *   The audio interrupt only copies samples out of the ring. The ring is filled by refill(),
+    *   which must be called from the main loop, so every SD access happens in one place and
+    *   can be scheduled around show data reads and writes.
+    */
+    class AudioPlayShowWav : public AudioStream {
+        public:
+            AudioPlayShowWav(void) : AudioStream(0, NULL) {}
+
+            /**
+            *   @brief  Open a WAV file and start playing once refill() has buffered samples
+            *
+            *   @param  fileName    8.3 file name to play
+            *   @param  startMillis Position to start playing from in milliseconds, 0 ... 4294967295
+            *   @return ```true``` if the file is a supported WAV file and ```false``` if not
+            */
+            bool play(const char* fileName, uint32_t startMillis);
+
+            /**
+            *   @brief  Open a WAV file without playing it, refill() can fill the ring before start()
+            *
+            *   @param  fileName    8.3 file name to play
+            *   @param  startMillis Position to start playing from in milliseconds, 0 ... 4294967295
+            *   @return ```true``` if the file is a supported WAV file and ```false``` if not
+            */
+            bool cue(const char* fileName, uint32_t startMillis);
+
+            /**
+            *   @brief  Start playing a cued file on the next audio update, safe to call from an interrupt
+            */
+            void start(void);
+
+            /**
+            *   @brief  Pause playing and keep the file open, start() resumes from the same sample
+            */
+            void pause(void);
+
+            /**
+            *   @brief  Get the time the first audio block was sent after start()
+            *
+            *   @return Returns micros() of the first block, 0 if none has been sent yet
+            */
+            uint32_t startMicros(void);
+
+            /**
+            *   @brief  Stop playing and close the WAV file
+            */
+            void stop(void);
+
+            /**
+            *   @brief  Read sectors from the WAV file into the ring buffer, each read ends at the wrap of the ring
+            *
+            *   @param  maxSectors  Max number of reads of up to one 512 byte sector
+            *   @return Returns the number of sectors read
+            */
+            uint16_t refill(uint16_t maxSectors);
+
+            /**
+            *   @brief  Check if the player is playing
+            *
+            *   @return ```true``` if playing and ```false``` if stopped or finished
+            */
+            bool isPlaying(void);
+
+            /**
+            *   @brief  Get the length of the open WAV file in milliseconds
+            *
+            *   @return Returns the length of the WAV file in milliseconds, 0 ... 4294967295
+            */
+            uint32_t lengthMillis(void);
+
+            /**
+            *   @brief  Get the play position in milliseconds
+            *
+            *   @return Returns the play position in milliseconds, 0 ... 4294967295
+            */
+            uint32_t positionMillis(void);
+
+            /**
+            *   @brief  Get the amount of audio buffered in the ring in milliseconds
+            *
+            *   @return Returns the buffered audio in milliseconds, 0 ... 93
+            */
+            uint32_t bufferedMillis(void);
+
+            /**
+            *   @brief  Copy mono samples from ahead of the play position, call from an audio update only
+            *
+            *   @param  aheadSamples    Samples ahead of the play position, limited to what is buffered
+            *   @param  mono            Buffer for the samples, stereo is mixed to mono
+            *   @param  count           Number of samples to copy
+            *   @return ```true``` if the samples were copied and ```false``` if not enough is buffered
+            */
+            bool peek(uint32_t aheadSamples, int16_t* mono, uint16_t count);
+
+            /**
+            *   @brief  Get the number of audio updates that found the ring empty
+            *
+            *   @return Returns the number of underruns since play()
+            */
+            uint32_t underruns(void);
+
+            virtual void update(void);
+
+        private:
+            File wavFile;
+            int16_t ring[WAV_RING_SAMPLES];
+            volatile uint32_t readPos = 0;
+            volatile uint32_t writePos = 0;
+            volatile uint32_t samplesPlayed = 0;
+            volatile uint32_t underrunCount = 0;
+            volatile bool playing = false;
+            volatile bool cued = false;
+            volatile uint32_t firstBlockMicros = 0;
+            volatile bool endOfData = false;
+            uint32_t dataRemaining = 0;
+            uint8_t oddByte = 0;  // 1 if the low byte of the sample at writePos has been read and its high byte has not
+            uint32_t dataSize = 0;
+            uint8_t channels = 2;
+    };
+
+#endif  // WAVPLAYER_H_